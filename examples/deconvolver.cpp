@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 17 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Example of the program which embeds the deconvolution. It uses only the installed public
+// headers and the shared library and is built after 'make install' with:
+//
+//   c++ -o deconvolver examples/deconvolver.cpp -lroom-raider
+
+#include <room-raider/deconvolver.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REF_LENGTH      8192
+#define TAKE_LENGTH     REF_LENGTH
+#define CHANNELS        2
+
+int main()
+{
+    // Reference: the decaying chirp
+    float *ref          = new float[REF_LENGTH];
+    for (size_t i=0; i<REF_LENGTH; ++i)
+        ref[i]              = sinf(i * (0.05f + i * 1e-4f)) * expf(-float(i) / REF_LENGTH);
+
+    // Take: the reference delayed differently in each channel, the take of the same length as the
+    // reference starts the response at the zero delay
+    float *take[CHANNELS], *response[CHANNELS];
+    for (size_t i=0; i<CHANNELS; ++i)
+    {
+        size_t delay        = 100 * (i + 1);
+        take[i]             = new float[TAKE_LENGTH];
+        response[i]         = new float[TAKE_LENGTH];
+        for (size_t n=0; n<TAKE_LENGTH; ++n)
+            take[i][n]          = ((n >= delay) && (n - delay < REF_LENGTH)) ? ref[n - delay] : 0.0f;
+    }
+
+    room_raider::Deconvolver d;
+    const float *vRef[1] = { ref };
+    int res             = d.init(vRef, 1, REF_LENGTH, TAKE_LENGTH, CHANNELS);
+    if (res == room_raider::DECONV_OK)
+        res                 = d.process(take, TAKE_LENGTH, response, TAKE_LENGTH);
+
+    // The peak of each response should be at the delay of the channel
+    for (size_t i=0; (res == room_raider::DECONV_OK) && (i < CHANNELS); ++i)
+    {
+        size_t peak         = 0;
+        for (size_t n=1; n<TAKE_LENGTH; ++n)
+            if (fabsf(response[i][n]) > fabsf(response[i][peak]))
+                peak                = n;
+
+        printf("Channel %d: peak at sample %d\n", int(i), int(peak));
+        if (peak != 100 * (i + 1))
+            res                 = room_raider::DECONV_FAILED;
+    }
+
+    if (res != room_raider::DECONV_OK)
+        fprintf(stderr, "Deconvolution failed, code=%d\n", res);
+
+    d.destroy();
+    for (size_t i=0; i<CHANNELS; ++i)
+    {
+        delete [] take[i];
+        delete [] response[i];
+    }
+    delete [] ref;
+
+    return (res == room_raider::DECONV_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
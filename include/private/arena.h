@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_ARENA_H_
+#define PRIVATE_ARENA_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Arena of aligned memory. The memory is reserved once for the peak footprint of the job
+     * and then handed out to the stages of the job as aligned slices. Stages return their slices
+     * by rewinding the arena to the mark taken before the allocation, the arena is reset between
+     * jobs and keeps the reserved memory.
+     */
+    typedef struct arena_t
+    {
+        size_t                  nCapacity;      // Capacity of the arena in bytes
+        size_t                  nUsed;          // Number of bytes handed out
+        bool                    bHugePages;     // Back large reservations with huge pages
+        uint8_t                *vData;          // Aligned memory
+        uint8_t                *pData;          // Allocated data
+    } arena_t;
+
+    /**
+     * Initialize empty arena
+     * @param a arena to initialize
+     * @param huge_pages advise the system to back large reservations with huge pages
+     */
+    void init_arena(arena_t *a, bool huge_pages);
+
+    /**
+     * Compute the size of the slice in the arena
+     * @param bytes number of bytes
+     * @return number of bytes occupied by the slice including the alignment
+     */
+    size_t arena_size(size_t bytes);
+
+    /**
+     * Compute the size of the slice in the arena
+     * @param count number of elements
+     * @return number of bytes occupied by the slice including the alignment
+     */
+    template <class T>
+        inline size_t arena_size(size_t count)
+        {
+            return arena_size(count * sizeof(T));
+        }
+
+    /**
+     * Make sure that the arena holds at least the specified number of bytes. The memory is
+     * reallocated only if the arena is too small, so it can be reserved for each job without
+     * page faults of the new allocation. The arena should be empty.
+     * @param a arena
+     * @param bytes number of bytes, should be computed with arena_size()
+     * @return status of operation
+     */
+    status_t reserve_arena(arena_t *a, size_t bytes);
+
+    /**
+     * Take the aligned slice from the arena
+     * @param a arena
+     * @param bytes number of bytes
+     * @return pointer to the slice or NULL if there is not enough free space in the arena
+     */
+    void *arena_alloc(arena_t *a, size_t bytes);
+
+    /**
+     * Take the aligned slice from the arena
+     * @param a arena
+     * @param count number of elements
+     * @return pointer to the slice or NULL if there is not enough free space in the arena
+     */
+    template <class T>
+        inline T *arena_alloc(arena_t *a, size_t count)
+        {
+            return static_cast<T *>(arena_alloc(a, count * sizeof(T)));
+        }
+
+    /**
+     * Return all slices taken after the mark to the arena
+     * @param a arena
+     * @param mark value of a->nUsed before the slices have been taken
+     */
+    void rewind_arena(arena_t *a, size_t mark);
+
+    /**
+     * Return all slices to the arena, the reserved memory is kept
+     * @param a arena
+     */
+    void reset_arena(arena_t *a);
+
+    /**
+     * Destroy the arena and free the reserved memory
+     * @param a arena
+     */
+    void destroy_arena(arena_t *a);
+}
+
+#endif /* PRIVATE_ARENA_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_BATCH_H_
+#define PRIVATE_BATCH_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <private/config.h>
+#include <private/stats.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Perform deconvolution of all jobs listed in the manifest file. Each non-empty line of
+     * the manifest which does not start with '#' defines one job as three comma-separated
+     * fields: input file, reference file and output file. Jobs are processed in parallel,
+     * the reference files are loaded and transformed only once for all jobs that share them.
+     *
+     * @param cfg configuration
+     * @param stats statistics, the loading stages of references are recorded
+     * @param norm_gain the normalization peak gain
+     * @return status of operation
+     */
+    status_t deconvolve_batch(const config_t *cfg, stats_t *stats, float norm_gain);
+}
+
+#endif /* PRIVATE_BATCH_H_ */
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_CACHE_H_
+#define PRIVATE_CACHE_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+#include <private/config.h>
+#include <private/dsp.h>
+#include <private/stats.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Loaded reference kept in the cache with the settings it has been loaded with
+     */
+    typedef struct ref_entry_t
+    {
+        LSPString                   sPath;          // Path to the reference file
+        wsize_t                     nSize;          // Size of the file at the moment of loading
+        wsize_t                     nModified;      // Modification time of the file at the moment of loading
+        ssize_t                     nSampleRate;    // Sample rate of the reference
+        ssize_t                     nSweepType;     // Type of the sweep
+        float                       fStartFreq;     // Start frequency of the sweep
+        float                       fEndFreq;       // End frequency of the sweep
+        float                       fSweepLength;   // Length of the sweep
+        ssize_t                     nRepeats;       // Number of repetitions of the sweep
+        bool                        bRegularize;    // Regularized inverse filter
+        float                       fRegLevel;      // Regularization level
+        dspu::Sample                sSample;        // Loaded reference
+        kernel_store_t              sKernels;       // Kernel spectra computed for the reference
+        status_t                    nStatus;        // Status of loading, valid when the loading lock is released
+        ipc::Mutex                  sLoading;       // Held by the job which loads the reference
+        size_t                      nRefs;          // Number of jobs using the entry
+        wsize_t                     nLastUse;       // Stamp of the last acquire or release of the entry
+        bool                        bStale;         // The file has changed, the entry is removed when released
+    } ref_entry_t;
+
+    /**
+     * Cache of references shared between jobs of the server or the batch
+     */
+    typedef struct ref_cache_t
+    {
+        lltl::parray<ref_entry_t>   vEntries;       // Cached references
+        size_t                      nCapacity;      // Maximum number of entries kept when not in use
+        wsize_t                     nClock;         // Counter to stamp the use of entries
+        ipc::Mutex                  sLock;          // Lock to access the cache
+    } ref_cache_t;
+
+    /**
+     * Initialize the cache, the least recently used entries are destroyed when the number
+     * of entries not in use exceeds the capacity
+     * @param cache reference cache
+     * @param capacity maximum number of entries kept when not in use
+     */
+    void init_ref_cache(ref_cache_t *cache, size_t capacity);
+
+    /**
+     * Get the reference from the cache or load it and put into the cache. The entry is considered
+     * to match if the file has the same size and modification time and the settings that affect
+     * the loaded reference and it's spectra are the same. The reference is loaded without holding
+     * the lock of the cache, jobs which request the same reference wait until it is loaded.
+     * The acquired entry should be released with release_reference().
+     * @param cache reference cache
+     * @param cfg configuration
+     * @param path path to the reference file
+     * @param stats statistics, the loading stages are recorded only if the reference is loaded
+     * @param threads maximum number of threads to resample the reference
+     * @param entry pointer to store the acquired entry
+     * @return status of operation
+     */
+    status_t acquire_reference(ref_cache_t *cache, const config_t *cfg, const LSPString *path, stats_t *stats, size_t threads, ref_entry_t **entry);
+
+    /**
+     * Release the reference acquired with acquire_reference()
+     * @param cache reference cache
+     * @param entry entry to release
+     */
+    void release_reference(ref_cache_t *cache, ref_entry_t *entry);
+
+    /**
+     * Destroy all entries of the cache, should be called when no entries are acquired
+     * @param cache reference cache
+     */
+    void destroy_ref_cache(ref_cache_t *cache);
+}
+
+#endif /* PRIVATE_CACHE_H_ */
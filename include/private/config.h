@@ -24,6 +24,7 @@
 
 #include <lsp-plug.in/common/types.h>
 #include <lsp-plug.in/runtime/LSPString.h>
+#include <lsp-plug.in/lltl/darray.h>
 
 namespace room_raider
 {
@@ -33,7 +34,9 @@ namespace room_raider
     {
         M_NONE,
         M_SWEEP,
-        M_DECONVOLVE
+        M_DECONVOLVE,
+        M_BATCH,
+        M_SERVE
     };
 
     enum normalize_t
@@ -44,6 +47,32 @@ namespace room_raider
         NORM_ALWAYS             // Always normalize
     };
 
+    enum sweep_type_t
+    {
+        SWEEP_LINEAR,           // Linear sine sweep
+        SWEEP_EXP               // Exponential sine sweep
+    };
+
+    enum stats_format_t
+    {
+        STATS_NONE,             // Do not collect statistics
+        STATS_JSON              // Output statistics in JSON format
+    };
+
+    enum sample_format_t
+    {
+        SAMPLE_F32,             // 32-bit floating-point samples
+        SAMPLE_S24,             // 24-bit signed integer samples
+        SAMPLE_S16              // 16-bit signed integer samples
+    };
+
+    enum container_t
+    {
+        CONTAINER_WAV,          // RIFF WAVE file
+        CONTAINER_RF64,         // RF64 file, allows files larger than 4 GB
+        CONTAINER_FLAC          // FLAC lossless compressed file, integer samples only
+    };
+
     /**
      * Overall configuration
      */
@@ -59,11 +88,38 @@ namespace room_raider
             float                                   fEndFreq;       // End frequency of sine sweep
             float                                   fGain;          // Gain of the sine sweep signal
             float                                   fSweepLength;   // The length of the sweep
+            ssize_t                                 nSweepType;     // Type of the sweep
+            ssize_t                                 nHarmonics;     // Highest order of harmonic distortion to extract, 0 = none
+            ssize_t                                 nRepeats;       // Number of repetitions of the sine sweep
             LSPString                               sInFile;        // Source file
             LSPString                               sOutFile;       // Destination file
             LSPString                               sReference;     // Reference file
+            LSPString                               sBatch;         // Batch manifest file
+            LSPString                               sInverse;       // Inverse filter file
+            LSPString                               sServe;         // Socket path of the job server
+            ssize_t                                 nServeCache;    // Maximum number of unused references kept by the server or batch
             ssize_t                                 nNormalize;     // Normalization method
             float                                   fNormGain;      // Normalization gain
+            ssize_t                                 nThreads;       // Number of worker threads, 0 = all CPU cores
+            bool                                    bStream;        // Streaming deconvolution
+            ssize_t                                 nBlockSize;     // Block size for streaming deconvolution, 0 = auto
+            ssize_t                                 nMaxMemory;     // Maximum memory usage in megabytes, 0 = unlimited
+            bool                                    bHugePages;     // Back the memory of jobs with huge pages
+            float                                   fIRLength;      // Length of the impulse response in ms, 0 = keep full length
+            bool                                    bIRAuto;        // Automatically truncate the impulse response at the noise floor
+            bool                                    bRegularize;    // Use regularized inverse filter instead of the matched filter
+            float                                   fRegLevel;      // In-band regularization level relative to the peak power, dB
+            bool                                    bMatrix;        // Deconvolve each input channel with each reference channel
+            lltl::darray<size_t>                    vRefMap;        // Reference channel for each input channel, empty = default
+            lltl::darray<size_t>                    vChannels;      // Input channels to deconvolve, empty = all
+            float                                   fWindowStart;   // Start of the impulse response window in ms
+            float                                   fWindowLength;  // Length of the impulse response window in ms, 0 = full response
+            ssize_t                                 nStats;         // Format of the processing statistics
+            LSPString                               sStatsFile;     // Statistics file, empty = standard output
+            bool                                    bLatency;       // Report latency and alignment of output channels
+            LSPString                               sLatencyFile;   // Latency report file, empty = standard output
+            ssize_t                                 nOutFormat;     // Sample format of output files
+            ssize_t                                 nOutContainer;  // Container of output files
 
         public:
             explicit config_t();
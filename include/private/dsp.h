@@ -22,14 +22,542 @@
 #define PRIVATE_DSP_H_
 
 #include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <private/arena.h>
 #include <private/config.h>
+#include <private/mapped.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/dsp-units/util/Oversampler.h>
 
 namespace room_raider
 {
+    /**
+     * Compute the number of worker threads to use
+     * @param cfg configuration
+     * @param jobs number of jobs that can be processed in parallel
+     * @return number of worker threads, at least 1
+     */
+    size_t select_threads(const config_t *cfg, size_t jobs);
+
+    /**
+     * Compute the minimum FFT rank which allows to hold the specified number of samples
+     * @param length number of samples
+     * @return FFT rank
+     */
+    size_t fft_rank(size_t length);
+
+    /**
+     * Synthesize the part of the sine sweep without oversampling
+     * @param cfg configuration: type of the sweep, start and end frequency, length
+     * @param dst destination buffer
+     * @param first index of the first sample to synthesize
+     * @param count number of samples to synthesize
+     * @param srate sample rate
+     */
+    void synth_sweep(const config_t *cfg, float *dst, size_t first, size_t count, size_t srate);
+
+    /**
+     * Block-wise sine sweep synthesizer with oversampling, memory usage does not depend
+     * on the length of the sweep
+     */
+    typedef struct sweep_synth_t
+    {
+        const config_t         *pConfig;        // Configuration
+        dspu::Oversampler       sOversampler;   // Oversampler to prevent aliasing
+        size_t                  nOversampling;  // Oversampling factor
+        size_t                  nOverRate;      // Oversampled sample rate
+        size_t                  nOffset;        // Number of already synthesized samples
+        size_t                  nLength;        // Length of the sweep in samples
+        float                   fGain;          // Gain of the sweep
+        float                  *vBuffer;        // Buffer for one block of oversampled samples
+        uint8_t                *pData;          // Allocated data
+    } sweep_synth_t;
+
+    /**
+     * Initialize the sweep synthesizer
+     * @param s synthesizer
+     * @param cfg configuration, should be kept alive until the synthesizer is destroyed
+     * @return status of operation
+     */
+    status_t init_sweep_synth(sweep_synth_t *s, const config_t *cfg);
+
+    /**
+     * Synthesize next samples of the sweep
+     * @param s synthesizer
+     * @param dst destination buffer
+     * @param count maximum number of samples to synthesize
+     * @return number of synthesized samples, less than count at the end of the sweep
+     */
+    size_t sweep_synth_process(sweep_synth_t *s, float *dst, size_t count);
+
+    /**
+     * Destroy the sweep synthesizer and free allocated memory
+     * @param s synthesizer
+     */
+    void destroy_sweep_synth(sweep_synth_t *s);
+
     status_t synth_test_sweep(const config_t *cfg, dspu::Sample &out);
 
-    status_t deconvolve(const config_t *cfg, const dspu::Sample &in, const dspu::Sample &ref, dspu::Sample &out);
+    /**
+     * Compute the period of the test signal: the sine sweep followed by the zero pad
+     * of the same length
+     * @param cfg configuration
+     * @return period of the test signal in samples
+     */
+    size_t sweep_period(const config_t *cfg);
+
+    /**
+     * Compute the rate of the exponential sine sweep: the time (in seconds) in which
+     * the instantaneous frequency of the sweep grows by the factor of e
+     * @param cfg configuration
+     * @return the rate of the exponential sweep
+     */
+    double exp_sweep_rate(const config_t *cfg);
+
+    /**
+     * Compute the time advance of the harmonic distortion IR relative to the linear IR
+     * for the exponential sine sweep
+     * @param cfg configuration
+     * @param order the order of the harmonic, 1 for the linear response
+     * @return time advance in samples
+     */
+    size_t harmonic_offset(const config_t *cfg, size_t order);
+
+    /**
+     * Compute the pre-delay of the harmonic distortion IRs
+     * @param cfg configuration
+     * @return pre-delay in samples, 0 if no harmonics should be extracted
+     */
+    size_t harmonic_predelay(const config_t *cfg);
+
+    /**
+     * Apply the amplitude envelope of the inverse filter to the reference. For the exponential
+     * sine sweep the envelope compensates the energy which grows towards low frequencies
+     * by 3 dB per octave, for the linear sweep the sample is left as is.
+     * @param cfg configuration
+     * @param dst reference sample to modify
+     */
+    void apply_sweep_envelope(const config_t *cfg, dspu::Sample *dst);
+
+    /**
+     * Spectrum of the deconvolution kernel, can be shared between several deconvolutions
+     * of inputs which require the same transform
+     */
+    typedef struct kernel_t
+    {
+        size_t                  nRadix;         // Radix of the mixed-radix transform: 1, 3 or 5
+        size_t                  nRank;          // FFT rank of the power-of-two part of the transform
+        size_t                  nLength;        // Length of the reference
+        float                  *vRe;            // Spectrum, real part
+        float                  *vIm;            // Spectrum, imaginary part
+        size_t                  nBlocks;        // Number of partitions of the reference, one spectrum per each
+        bool                    bCalibrated;    // Regularized inverse filter, the result is not normalized
+        uint8_t                *pData;          // Allocated data
+    } kernel_t;
+
+    /**
+     * Compute the size of the mixed-radix transform required to deconvolve the input with the reference,
+     * the size of the transform is radix * 2^rank
+     * @param in_length length of the input
+     * @param ref_length length of the reference
+     * @param radix pointer to store the radix of the transform
+     * @return FFT rank of the power-of-two part of the transform
+     */
+    size_t deconv_rank(size_t in_length, size_t ref_length, size_t *radix);
+
+    /**
+     * Initialize empty kernel
+     * @param k kernel to initialize
+     */
+    void init_kernel(kernel_t *k);
+
+    /**
+     * Compute the spectrum of the deconvolution kernel
+     * @param k kernel to store the spectrum
+     * @param ref reference sample
+     * @param channel channel of the reference sample to use
+     * @param radix radix of the transform computed by deconv_rank()
+     * @param rank FFT rank computed by deconv_rank()
+     * @param arena arena to take the memory of the spectrum from, the memory is allocated for the kernel
+     *   if the arena is NULL or has not enough free space. The arena should not be rewound while the kernel is used
+     * @return status of operation
+     */
+    status_t build_kernel(kernel_t *k, const dspu::Sample &ref, size_t channel, size_t radix, size_t rank, arena_t *arena);
+
+    /**
+     * Compute the spectrum of the deconvolution kernel from the channel of the reference
+     * @param k kernel to store the spectrum
+     * @param ref samples of the reference channel
+     * @param length length of the reference
+     * @param radix radix of the transform computed by deconv_rank()
+     * @param rank FFT rank computed by deconv_rank()
+     * @param arena arena to take the memory of the spectrum from, the memory is allocated for the kernel
+     *   if the arena is NULL or has not enough free space. The arena should not be rewound while the kernel is used
+     * @return status of operation
+     */
+    status_t build_kernel(kernel_t *k, const float *ref, size_t length, size_t radix, size_t rank, arena_t *arena);
+
+    /**
+     * Get the window of the impulse response to compute according to the configuration
+     * @param cfg configuration
+     * @param first pointer to store the offset of the window after the origin of time in samples
+     * @param length pointer to store the length of the window in samples
+     * @return true if the window is configured, false if the full impulse response should be computed
+     */
+    bool ir_window(const config_t *cfg, size_t *first, size_t *length);
+
+    /**
+     * Compute the FFT rank of the partitioned deconvolution which computes only the window of the result.
+     * The rank does not depend on the length of the input and reference, so the transform stays small.
+     * @param length length of the window
+     * @return FFT rank
+     */
+    size_t window_rank(size_t length);
+
+    /**
+     * Compute the spectra of the partitioned deconvolution kernel: the reference is split into blocks
+     * of (2^rank - length + 1) samples and each block is transformed separately. Trailing silence of the
+     * reference does not produce any blocks.
+     * @param k kernel to store the spectra
+     * @param ref reference sample
+     * @param channel channel of the reference sample to use
+     * @param rank FFT rank computed by window_rank()
+     * @param length length of the window
+     * @param arena arena to take the memory of the spectrum from, the memory is allocated for the kernel
+     *   if the arena is NULL or has not enough free space. The arena should not be rewound while the kernel is used
+     * @return status of operation
+     */
+    status_t build_window_kernel(kernel_t *k, const dspu::Sample &ref, size_t channel, size_t rank, size_t length, arena_t *arena);
+
+    /**
+     * Turn the kernel into the regularized (Kirkeby) inverse filter of the reference: K / (|K|^2 + eps(f)).
+     * The regularization eps(f) is set by the configured level relative to the peak power of the reference
+     * inside the band of the sweep and rises to the peak power outside of it, so the out-of-band noise
+     * is not amplified. The deconvolution with such kernel gives the calibrated response which is not
+     * normalized.
+     * @param cfg configuration: start and end frequency of the sweep, regularization level, sample rate
+     * @param k kernel computed by build_kernel()
+     */
+    void regularize_kernel(const config_t *cfg, kernel_t *k);
+
+    /**
+     * Destroy kernel and free allocated memory
+     * @param k kernel to destroy
+     */
+    void destroy_kernel(kernel_t *k);
+
+    /**
+     * Kernel kept in the storage
+     */
+    typedef struct stored_kernel_t
+    {
+        size_t                  nChannel;       // Channel of the reference
+        size_t                  nWindow;        // Length of the window for the partitioned kernel, 0 for the full kernel
+        size_t                  nRadix;         // Radix of the transform
+        size_t                  nRank;          // Rank of the transform
+        size_t                  nLength;        // Length of the reference
+        kernel_t                sKernel;        // Kernel spectrum
+        status_t                nStatus;        // Status of computation, valid when the loading lock is released
+        size_t                  nRefs;          // Number of deconvolutions using the kernel
+        wsize_t                 nLastUse;       // Stamp of the last acquire or release of the kernel
+        ipc::Mutex              sLoading;       // Held by the deconvolution which computes the kernel
+    } stored_kernel_t;
+
+    /**
+     * Storage of kernel spectra which are kept between deconvolutions with the same reference
+     * and configuration, can be shared between threads. For each channel of the reference only
+     * a few least recently used kernels which are not in use are kept.
+     */
+    typedef struct kernel_store_t
+    {
+        lltl::parray<stored_kernel_t>   vItems;         // Stored kernels
+        wsize_t                         nClock;         // Counter to stamp the use of kernels
+        ipc::Mutex                      sLock;          // Lock to access the storage
+    } kernel_store_t;
+
+    /**
+     * Initialize the kernel storage
+     * @param s kernel storage
+     */
+    void init_kernel_store(kernel_store_t *s);
+
+    /**
+     * Destroy all kernels kept in the storage, should be called when no kernels are acquired
+     * @param s kernel storage
+     */
+    void destroy_kernel_store(kernel_store_t *s);
+
+    /**
+     * Get the kernel of the reference channel from the storage or compute it according to the
+     * configuration and keep in the storage. The kernel is computed without holding the lock of
+     * the storage, deconvolutions which request the same kernel wait until it is computed.
+     * The acquired kernel should be released with release_kernel().
+     * @param cfg configuration
+     * @param store kernel storage
+     * @param ref reference sample
+     * @param channel channel of the reference
+     * @param radix radix of the transform
+     * @param rank rank of the transform
+     * @param window length of the window for the partitioned kernel, 0 for the full kernel
+     * @param dst pointer to store the acquired kernel
+     * @return status of operation
+     */
+    status_t acquire_kernel(const config_t *cfg, kernel_store_t *store, const dspu::Sample &ref, size_t channel,
+        size_t radix, size_t rank, size_t window, stored_kernel_t **dst);
+
+    /**
+     * Release the kernel acquired with acquire_kernel()
+     * @param store kernel storage
+     * @param item kernel to release
+     */
+    void release_kernel(kernel_store_t *store, stored_kernel_t *item);
+
+    /**
+     * Route of the deconvolution: the pair of the input channel and the kernel
+     * which produce one channel of the output
+     */
+    typedef struct route_t
+    {
+        size_t                  nInput;         // Index of the input channel
+        size_t                  nKernel;        // Index of the kernel
+    } route_t;
+
+    /**
+     * Build the deconvolution routes according to the configuration. A mono reference is applied
+     * to all input channels, the reference with the same number of channels as the input is
+     * applied channel by channel. Otherwise the reference map or the matrix mode is required.
+     * In the matrix mode the output channel s*M + m contains the response of input m to the
+     * reference channel s, where M is the number of input channels. If the list of input channels
+     * is configured, other input channels are not routed and M is the size of the list.
+     * @param cfg configuration
+     * @param in_channels number of input channels
+     * @param ref_channels number of reference channels
+     * @param routes array to store routes, one per each output channel
+     * @return status of operation
+     */
+    status_t build_routes(const config_t *cfg, size_t in_channels, size_t ref_channels, lltl::darray<route_t> *routes);
+
+    /**
+     * Latency of the output channel estimated from the peak of the deconvolution result
+     */
+    typedef struct latency_t
+    {
+        float                   fDelay;         // Delay of the peak after the origin of time, fractional samples
+        float                   fPeak;          // Value of the peak before normalization, the sign is the polarity
+    } latency_t;
+
+    /**
+     * Estimate the latency from the deconvolution result: find the absolute peak and refine it's
+     * position with the parabolic interpolation
+     * @param dst latency to store
+     * @param src deconvolution result starting at the origin of time
+     * @param count number of samples to search
+     */
+    void estimate_latency(latency_t *dst, const float *src, size_t count);
+
+    /**
+     * Deconvolve the input with several precomputed kernels. The spectrum of each pair of input channels
+     * is computed only once and then shared between all kernels routed to these channels.
+     * @param in input sample
+     * @param kernels list of kernel spectra, all should be built for deconv_rank() of the input and reference
+     * @param nkernels number of kernels
+     * @param routes routes, one per each channel of the output
+     * @param out output sample
+     * @param threads maximum number of threads to use
+     * @param lead number of samples before the origin of time to keep at the beginning of the output,
+     *   should be less than the length of the longest of input and reference
+     * @return status of operation
+     */
+    status_t deconvolve(const dspu::Sample &in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t lead);
+
+    /**
+     * Compute the size of the arena required by the deconvolution
+     * @param radix radix of the transform of the kernels
+     * @param rank FFT rank of the kernels
+     * @param nkernels number of kernels
+     * @param threads maximum number of threads
+     * @return size of the arena in bytes
+     */
+    size_t deconv_arena_size(size_t radix, size_t rank, size_t nkernels, size_t threads);
+
+    /**
+     * Deconvolve the input with several precomputed kernels using the memory of the arena. The kernels
+     * may be built for the transform larger than deconv_rank() of the input and reference, so the same kernels
+     * and the arena can be reused for inputs of different length.
+     * @param in input sample
+     * @param kernels list of kernel spectra, all should be built for the same transform not less than deconv_rank()
+     * @param nkernels number of kernels
+     * @param routes routes, one per each channel of the output
+     * @param out output sample
+     * @param threads maximum number of threads to use
+     * @param lead number of samples before the origin of time to keep at the beginning of the output
+     * @param arena arena to take the working buffers from, the memory is allocated for the call
+     *   if the arena is NULL or has not enough free space
+     * @return status of operation
+     */
+    status_t deconvolve(const dspu::Sample &in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t lead, arena_t *arena);
+
+    /**
+     * Deconvolve the input given as buffers of channels with several precomputed kernels using
+     * the memory of the arena, the result is written to the buffers of output channels
+     * @param in buffers of input channels
+     * @param in_channels number of input channels
+     * @param in_length length of input channels
+     * @param kernels list of kernel spectra, all should be built for the same transform not less than deconv_rank()
+     * @param nkernels number of kernels
+     * @param routes routes, one per each channel of the output
+     * @param out buffers of output channels
+     * @param out_channels number of output channels
+     * @param out_length length of output channels
+     * @param threads maximum number of threads to use
+     * @param lead number of samples before the origin of time to keep at the beginning of the output
+     * @param arena arena to take the working buffers from, may be NULL
+     * @return status of operation
+     */
+    status_t deconvolve(const float * const *in, size_t in_channels, size_t in_length,
+        const kernel_t * const *kernels, size_t nkernels, const route_t *routes,
+        float * const *out, size_t out_channels, size_t out_length, size_t threads, size_t lead, arena_t *arena);
+
+    /**
+     * Deconvolve the input with several partitioned kernels, only the window of the result is computed.
+     * The cost depends on the length of the reference and the window but not on the length of the input.
+     * @param in input sample
+     * @param kernels list of kernel spectra, all should be built by build_window_kernel() for the same window
+     * @param nkernels number of kernels
+     * @param routes routes, one per each channel of the output
+     * @param out output sample
+     * @param threads maximum number of threads to use
+     * @param first offset of the window after the origin of time
+     * @param length length of the window
+     * @return status of operation
+     */
+    status_t deconvolve_window(const dspu::Sample &in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t first, size_t length);
+
+    /**
+     * Deconvolve the input with the precomputed kernel
+     * @param in input sample
+     * @param kernel kernel spectrum, should be built for deconv_rank() of the input and reference
+     * @param out output sample
+     * @param threads maximum number of threads to use
+     * @param lead number of samples before the origin of time to keep at the beginning of the output,
+     *   should be less than the length of the longest of input and reference
+     * @param arena arena to take the working buffers from, may be NULL
+     * @return status of operation
+     */
+    status_t deconvolve(const dspu::Sample &in, const kernel_t *kernel, dspu::Sample &out, size_t threads, size_t lead,
+        arena_t *arena);
+
+    /**
+     * Deconvolve the input with all channels of the reference according to the routes
+     * computed by build_routes(). If the window of the impulse response is configured, only the
+     * window is computed and the output starts at the beginning of the window.
+     * @param cfg configuration
+     * @param in input sample
+     * @param ref reference sample
+     * @param out output sample, should have one channel per each route
+     * @param lead number of samples before the origin of time to keep at the beginning of the output
+     * @param latency array to store the latency of each output channel, may be NULL
+     * @param store storage to take the kernels from and keep computed kernels in, may be NULL
+     * @param arena arena to take the working buffers from, may be NULL
+     * @return status of operation
+     */
+    status_t deconvolve(const config_t *cfg, const dspu::Sample &in, const dspu::Sample &ref, dspu::Sample &out,
+        size_t lead, latency_t *latency, kernel_store_t *store, arena_t *arena);
+
+    /**
+     * Deconvolve the memory-mapped input with all channels of the reference according to the routes
+     * computed by build_routes(). The window of the impulse response is handled the same way as for
+     * the sample. Samples are converted from the mapping directly into the transform
+     * buffers, so the input is not decoded into memory. The sample rate of the input file should
+     * match the configuration.
+     * @param cfg configuration
+     * @param in memory-mapped input file
+     * @param ref reference sample
+     * @param out output sample, should have one channel per each route
+     * @param lead number of samples before the origin of time to keep at the beginning of the output
+     * @param latency array to store the latency of each output channel, may be NULL
+     * @param store storage to take the kernels from and keep computed kernels in, may be NULL
+     * @param arena arena to take the working buffers from, may be NULL
+     * @return status of operation
+     */
+    status_t deconvolve(const config_t *cfg, const mapped_wav_t *in, const dspu::Sample &ref, dspu::Sample &out,
+        size_t lead, latency_t *latency, kernel_store_t *store, arena_t *arena);
+
+    /**
+     * Compute the size of the arena required by the deconvolution of the input with all channels
+     * of the reference according to the configuration
+     * @param cfg configuration
+     * @param in_channels number of channels of the input
+     * @param in_length length of the input
+     * @param ref_channels number of channels of the reference
+     * @param ref_length length of the reference
+     * @param stored kernels are taken from the storage, otherwise their spectra are also taken from the arena
+     * @return size of the arena in bytes
+     */
+    size_t deconv_arena_size(const config_t *cfg, size_t in_channels, size_t in_length,
+        size_t ref_channels, size_t ref_length, bool stored);
+
+    /**
+     * Get the size of the block used for energy estimation of the impulse response
+     * @param cfg configuration
+     * @return size of the block in samples
+     */
+    size_t ir_block_size(const config_t *cfg);
+
+    /**
+     * Find the point where the decay of the impulse response reaches the noise floor
+     * @param energy energies of consecutive blocks of the impulse response
+     * @param count number of blocks
+     * @return number of blocks to keep
+     */
+    size_t ir_decay_blocks(const float *energy, size_t count);
+
+    /**
+     * Compute the length of the impulse response to keep according to the configuration
+     * @param cfg configuration
+     * @param energy energies of blocks of ir_block_size() samples for each channel, one channel
+     *   after another, may be NULL if automatic length estimation is not enabled
+     * @param channels number of channels
+     * @param length length of the impulse response
+     * @return length of the impulse response to keep
+     */
+    size_t ir_length(const config_t *cfg, const float *energy, size_t channels, size_t length);
+
+    /**
+     * Compute the length of the impulse response to keep according to the configuration
+     * @param cfg configuration
+     * @param ir sample containing the impulse response
+     * @param first offset of the impulse response in the sample
+     * @param length length of the impulse response
+     * @param keep pointer to store the length of the impulse response to keep
+     * @param arena arena to take the working buffers from, may be NULL
+     * @return status of operation
+     */
+    status_t estimate_ir_length(const config_t *cfg, const dspu::Sample &ir, size_t first, size_t length, size_t *keep,
+        arena_t *arena);
+
+    /**
+     * Compute the size of the arena required by estimate_ir_length()
+     * @param cfg configuration
+     * @param channels number of channels of the impulse response
+     * @param length length of the impulse response
+     * @return size of the arena in bytes
+     */
+    size_t ir_length_arena_size(const config_t *cfg, size_t channels, size_t length);
+
+    /**
+     * Compute the gain to apply to the signal with the specified peak for normalization
+     * @param peak the maximum peak of the signal
+     * @param gain the maximum peak gain
+     * @param mode the normalization mode
+     * @return gain to apply, 1.0 if signal should be left as is
+     */
+    float normalizing_gain(float peak, float gain, size_t mode);
 
     /**
      * Normalize sample to the specified gain
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_FFT_H_
+#define PRIVATE_FFT_H_
+
+#include <lsp-plug.in/common/types.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Compute the size of the mixed-radix transform which allows to hold the specified number of samples.
+     * The size of the transform is radix * 2^rank where radix is 1, 3 or 5, the smallest size is selected.
+     * @param length number of samples
+     * @param radix pointer to store the radix of the transform
+     * @return rank of the power-of-two part of the transform
+     */
+    size_t mixed_fft_rank(size_t length, size_t *radix);
+
+    /**
+     * Compute the position of the frequency bin in the spectrum computed by mixed_direct_fft().
+     * The spectrum of the mixed-radix transform is stored as radix blocks of 2^rank bins,
+     * the block k holds the bins with index k modulo radix.
+     * @param index index of the frequency bin
+     * @param radix radix of the transform
+     * @param rank rank of the power-of-two part of the transform
+     * @return position of the bin in the spectrum
+     */
+    inline size_t mixed_fft_bin(size_t index, size_t radix, size_t rank)
+    {
+        return ((index % radix) << rank) + index / radix;
+    }
+
+    /**
+     * Compute the direct mixed-radix FFT in place. The bins of the spectrum are reordered
+     * as described for mixed_fft_bin(), the order does not matter for the products of spectra.
+     * @param re real part of the signal
+     * @param im imaginary part of the signal
+     * @param radix radix of the transform: 1, 3 or 5
+     * @param rank rank of the power-of-two part of the transform
+     */
+    void mixed_direct_fft(float *re, float *im, size_t radix, size_t rank);
+
+    /**
+     * Compute the normalized reverse mixed-radix FFT in place of the spectrum computed by mixed_direct_fft()
+     * @param re real part of the spectrum
+     * @param im imaginary part of the spectrum
+     * @param radix radix of the transform: 1, 3 or 5
+     * @param rank rank of the power-of-two part of the transform
+     */
+    void mixed_reverse_fft(float *re, float *im, size_t radix, size_t rank);
+}
+
+#endif /* PRIVATE_FFT_H_ */
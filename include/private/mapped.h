@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_MAPPED_H_
+#define PRIVATE_MAPPED_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Sample formats of the memory-mapped audio file
+     */
+    enum mapped_format_t
+    {
+        MFMT_U8,                // Unsigned 8-bit PCM
+        MFMT_S16,               // Signed 16-bit PCM
+        MFMT_S24,               // Signed 24-bit PCM
+        MFMT_S32,               // Signed 32-bit PCM
+        MFMT_F32,               // 32-bit IEEE float
+        MFMT_F64                // 64-bit IEEE float
+    };
+
+    /**
+     * Uncompressed WAV or RF64 file mapped into memory, samples are converted
+     * directly from the mapping without decoding the whole file
+     */
+    typedef struct mapped_wav_t
+    {
+        size_t                  nChannels;      // Number of channels
+        size_t                  nSampleRate;    // Sample rate
+        wsize_t                 nFrames;        // Number of frames
+        size_t                  nFormat;        // Sample format
+        size_t                  nSampleSize;    // Size of one sample in bytes
+        size_t                  nFrameSize;     // Size of one frame in bytes
+        const uint8_t          *pFrames;        // Pointer to the first frame
+        uint8_t                *pMap;           // Mapped file
+        wsize_t                 nMapSize;       // Size of the mapping
+        void                   *hFile;          // Platform-specific file handle
+        void                   *hMapping;       // Platform-specific mapping handle
+    } mapped_wav_t;
+
+    /**
+     * Initialize the mapped file structure
+     * @param w mapped file
+     */
+    void init_mapped_wav(mapped_wav_t *w);
+
+    /**
+     * Map the audio file into memory and parse it's header. Files larger than 4 GB
+     * are supported in RF64 format on 64-bit platforms.
+     * @param w mapped file
+     * @param path path to the file
+     * @return status of operation, STATUS_UNSUPPORTED_FORMAT if the file is not an uncompressed
+     *   PCM or IEEE float WAV or RF64 file, in this case the file should be read by other means
+     */
+    status_t open_mapped_wav(mapped_wav_t *w, const LSPString *path);
+
+    /**
+     * Ask the system to read the samples of the mapped file in the background, so the file is
+     * being read from disk while other work is done and the conversion finds the pages in memory
+     * @param w mapped file
+     */
+    void prefetch_mapped_wav(const mapped_wav_t *w);
+
+    /**
+     * Convert samples of several channels to floating-point values, the frames are read
+     * from the mapping once for all channels
+     * @param w mapped file
+     * @param dst destination buffer of each channel
+     * @param channels indices of channels
+     * @param n number of channels
+     * @param first index of the first frame
+     * @param count number of frames to convert, should not exceed the length of the file
+     */
+    void read_mapped_channels(const mapped_wav_t *w, float * const *dst, const size_t *channels, size_t n,
+        wsize_t first, size_t count);
+
+    /**
+     * Unmap the file and close it
+     * @param w mapped file
+     */
+    void close_mapped_wav(mapped_wav_t *w);
+}
+
+#endif /* PRIVATE_MAPPED_H_ */
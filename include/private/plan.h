@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_PLAN_H_
+#define PRIVATE_PLAN_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <private/config.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Execution strategy of the deconvolution
+     */
+    enum strategy_t
+    {
+        STRATEGY_WHOLE,         // Whole files are loaded into memory, channels are processed in parallel
+        STRATEGY_SEQUENTIAL,    // Whole files are loaded into memory, channels are processed one after another
+        STRATEGY_CHUNKED        // Input file is processed by chunks (streaming mode)
+    };
+
+    /**
+     * Execution plan of the deconvolution
+     */
+    typedef struct plan_t
+    {
+        strategy_t          enStrategy;     // Execution strategy
+        size_t              nThreads;       // Number of worker threads
+        size_t              nBlockSize;     // Block size for the chunked strategy
+        wsize_t             nMemory;        // Estimated peak memory usage in bytes
+    } plan_t;
+
+    /**
+     * Estimate the peak memory usage of the deconvolution from headers of the input and the
+     * reference files, and select the fastest execution strategy which fits into the memory
+     * limit set by the configuration.
+     *
+     * @param cfg configuration
+     * @param plan pointer to store the execution plan
+     * @return status of operation, STATUS_NO_MEM if there is no strategy which fits into the limit
+     */
+    status_t plan_deconvolution(const config_t *cfg, plan_t *plan);
+
+    /**
+     * Apply the execution plan to the configuration
+     * @param cfg configuration to modify
+     * @param plan execution plan
+     */
+    void apply_plan(config_t *cfg, const plan_t *plan);
+
+    /**
+     * Get the human-readable name of the strategy
+     * @param strategy strategy
+     * @return name of the strategy
+     */
+    const char *strategy_name(strategy_t strategy);
+}
+
+#endif /* PRIVATE_PLAN_H_ */
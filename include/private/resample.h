@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_RESAMPLE_H_
+#define PRIVATE_RESAMPLE_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/mm/IInAudioStream.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Rational resampler: the signal is interpolated by nUp, filtered with the Lanczos
+     * windowed sinc and decimated by nDown, the filter is stored as a polyphase table
+     */
+    typedef struct resampler_t
+    {
+        size_t                  nUp;            // Interpolation factor
+        size_t                  nDown;          // Decimation factor
+        size_t                  nTaps;          // Number of taps of each phase, even
+        float                  *vKernel;        // Kernel, nUp phases of nTaps taps each
+        uint8_t                *pData;          // Allocated data
+    } resampler_t;
+
+    /**
+     * Block-wise resampler of the audio stream
+     */
+    typedef struct resample_stream_t
+    {
+        mm::IInAudioStream     *pIn;            // Input stream
+        resampler_t             sResampler;     // Resampler
+        size_t                  nChannels;      // Number of channels
+        size_t                  nChunk;         // Size of the input chunk in frames
+        size_t                  nCapacity;      // Capacity of the history of each channel
+        wssize_t                nBase;          // Index of the first input sample in the history
+        size_t                  nAvail;         // Number of input samples in the history
+        wsize_t                 nOut;           // Index of the next output sample
+        wsize_t                 nLength;        // Overall number of output samples
+        bool                    bEof;           // End of input stream has been reached
+        float                  *vChunk;         // Interleaved input chunk
+        float                  *vHistory;       // History of each channel
+        uint8_t                *pData;          // Allocated data
+    } resample_stream_t;
+
+    /**
+     * Initialize the resampler
+     * @param r resampler
+     * @param src_rate source sample rate
+     * @param dst_rate destination sample rate
+     * @return status of operation, STATUS_UNSUPPORTED_FORMAT if the ratio of sample rates
+     *   requires too large polyphase table
+     */
+    status_t init_resampler(resampler_t *r, size_t src_rate, size_t dst_rate);
+
+    /**
+     * Destroy the resampler
+     * @param r resampler
+     */
+    void destroy_resampler(resampler_t *r);
+
+    /**
+     * Compute the length of the resampled signal
+     * @param r resampler
+     * @param length length of the source signal
+     * @return length of the resampled signal
+     */
+    wsize_t resampled_length(const resampler_t *r, wsize_t length);
+
+    /**
+     * Resample the sample in place. Nothing is done if the sample rate already matches,
+     * channels are resampled in parallel. The decimated signal is computed in the buffers
+     * of the sample, the interpolated one needs new buffers for all channels, so the peak
+     * memory is lowered only by the block-wise resampling of the streaming mode.
+     *
+     * @param s sample to resample
+     * @param srate desired sample rate
+     * @param threads maximum number of threads to use
+     * @return status of operation
+     */
+    status_t resample(dspu::Sample *s, size_t srate, size_t threads);
+
+    /**
+     * Initialize block-wise resampler of the audio stream
+     * @param rs stream resampler
+     * @param is input stream, the length of the stream should be known
+     * @param srate desired sample rate
+     * @return status of operation
+     */
+    status_t init_resample_stream(resample_stream_t *rs, mm::IInAudioStream *is, size_t srate);
+
+    /**
+     * Read resampled frames
+     * @param rs stream resampler
+     * @param dst destination buffer to store interleaved frames
+     * @param frames number of frames to read
+     * @param count pointer to store number of frames actually read, less than requested
+     *   only at the end of stream
+     * @return status of operation
+     */
+    status_t resample_stream_read(resample_stream_t *rs, float *dst, size_t frames, size_t *count);
+
+    /**
+     * Destroy block-wise resampler of the audio stream
+     * @param rs stream resampler
+     */
+    void destroy_resample_stream(resample_stream_t *rs);
+}
+
+#endif /* PRIVATE_RESAMPLE_H_ */
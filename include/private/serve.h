@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_SERVE_H_
+#define PRIVATE_SERVE_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <private/config.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Run the job server on the Unix domain socket specified by the configuration. Each
+     * connection submits one job as a single line of command line arguments, the job is
+     * processed with the references and their spectra kept in memory between jobs, the
+     * stages of the job and the result are reported back to the client. Jobs of different
+     * connections are processed in parallel, the number of concurrent jobs is limited by
+     * the number of threads of the configuration. The server runs until a client sends
+     * the SHUTDOWN line. Not supported on Windows.
+     *
+     * @param cfg configuration of the server
+     * @return status of operation
+     */
+    status_t serve(const config_t *cfg);
+}
+
+#endif /* PRIVATE_SERVE_H_ */
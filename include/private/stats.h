@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_STATS_H_
+#define PRIVATE_STATS_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <private/config.h>
+#include <private/dsp.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Resource usage snapshot
+     */
+    typedef struct usage_t
+    {
+        double              fWall;          // Wall clock time, seconds
+        double              fCpu;           // CPU time of the process (user + system), seconds
+        double              fThreadCpu;     // CPU time of the calling thread (user + system), seconds
+        wsize_t             nPeakRSS;       // Peak resident set size of the process, bytes
+    } usage_t;
+
+    /**
+     * Statistics of one processing stage
+     */
+    typedef struct stage_t
+    {
+        const char         *sName;          // Name of the stage
+        size_t              nChannels;      // Number of processed channels, 0 if not applicable
+        double              fWall;          // Wall clock time, seconds
+        double              fCpu;           // CPU time of the thread which has run the stage, seconds
+        double              fProcessCpu;    // CPU time of the whole process during the stage, seconds
+        wsize_t             nRead;          // Number of bytes read from disk
+        wsize_t             nWritten;       // Number of bytes written to disk
+        wsize_t             nPeakRSS;       // Peak resident set size at the end of stage, bytes
+    } stage_t;
+
+    /**
+     * Hook called each time the stage has been recorded
+     * @param st statistics of the stage
+     * @param arg argument of the hook
+     */
+    typedef void (* stage_hook_t)(const stage_t *st, void *arg);
+
+    /**
+     * Statistics of the whole run, stages may be recorded by several threads
+     */
+    typedef struct stats_t
+    {
+        bool                    bEnabled;   // Statistics should be collected
+        usage_t                 sStart;     // Resource usage at the start of the run
+        lltl::darray<stage_t>   vStages;    // Stages in the order of completion
+        stage_hook_t            pHook;      // Hook called for each recorded stage, may be NULL
+        void                   *pHookArg;   // Argument of the hook
+        ipc::Mutex              sLock;      // Lock to record stages
+    } stats_t;
+
+    /**
+     * Initialize statistics and take the initial resource usage snapshot
+     * @param s statistics
+     * @param cfg configuration
+     */
+    void init_stats(stats_t *s, const config_t *cfg);
+
+    /**
+     * Take the resource usage snapshot
+     * @param u pointer to store the snapshot
+     */
+    void get_usage(usage_t *u);
+
+    /**
+     * Begin the stage
+     * @param s statistics
+     * @param u pointer to store the resource usage at the start of the stage
+     */
+    void stage_begin(const stats_t *s, usage_t *u);
+
+    /**
+     * End the stage and record it's statistics, does nothing if statistics are disabled.
+     * The CPU time is measured for the thread which calls stage_begin() and stage_end(), so
+     * concurrent stages do not include the time of each other, the time of the worker threads
+     * started by the stage is included only in the CPU time of the process. The peak memory is
+     * measured for the whole process.
+     * @param s statistics
+     * @param u resource usage at the start of the stage
+     * @param name name of the stage, should be a static string
+     * @param channels number of processed channels, 0 if not applicable
+     * @param read number of bytes read from disk
+     * @param written number of bytes written to disk
+     */
+    void stage_end(stats_t *s, const usage_t *u, const char *name, size_t channels, wsize_t read, wsize_t written);
+
+    /**
+     * Get the size of the file on disk
+     * @param path path to the file
+     * @return size of the file in bytes, 0 on error
+     */
+    wsize_t file_size(const LSPString *path);
+
+    /**
+     * Get the amount of physical memory available to the process without swapping
+     * @return amount of memory in bytes, 0 if it is unknown
+     */
+    wsize_t available_memory();
+
+    /**
+     * Format statistics in JSON format
+     * @param out string to append the formatted statistics
+     * @param s statistics
+     * @param cfg configuration
+     * @return true on success, false if there is not enough memory
+     */
+    bool format_stats(LSPString *out, const stats_t *s, const config_t *cfg);
+
+    /**
+     * Output statistics in the format specified by the configuration to the statistics file
+     * or to the standard output
+     * @param s statistics
+     * @param cfg configuration
+     * @return status of operation
+     */
+    status_t write_stats(const stats_t *s, const config_t *cfg);
+
+    /**
+     * Output the latency and alignment report in CSV format to the latency file or to the
+     * standard output. For each output channel the input channel, the reference channel, the
+     * latency in samples and milliseconds, the latency relative to the earliest output channel
+     * with the same reference channel and the polarity of the peak are reported.
+     * @param cfg configuration
+     * @param routes routes of the deconvolution, one per each output channel
+     * @param latency latency of each output channel
+     * @param count number of output channels
+     * @return status of operation
+     */
+    status_t write_latency(const config_t *cfg, const route_t *routes, const latency_t *latency, size_t count);
+}
+
+#endif /* PRIVATE_STATS_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_STREAM_H_
+#define PRIVATE_STREAM_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <private/arena.h>
+#include <private/config.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Get the rank of the block size of the streaming deconvolution
+     *
+     * @param block_size block size set by the configuration, 0 for the default block size
+     * @param kernel length of the kernel in samples
+     * @return rank of the block size
+     */
+    size_t stream_rank(ssize_t block_size, size_t kernel);
+
+    /**
+     * Estimate memory usage of the streaming deconvolution, in samples
+     *
+     * @param channels number of input channels
+     * @param kernel length of the kernel in samples
+     * @param rank rank of the block size
+     * @param pairs number of channel pairs deconvolved in one pass over the input
+     * @return memory usage in samples
+     */
+    wsize_t stream_usage(size_t channels, size_t kernel, size_t rank, size_t pairs);
+
+    /**
+     * Select the number of channel pairs deconvolved in one pass over the input. As many pairs
+     * as fit into the memory limit of the configuration are taken, but at least one. Without the
+     * limit, the memory usage should not exceed the memory of the input and the output.
+     *
+     * @param cfg configuration
+     * @param channels number of input channels
+     * @param in_length length of the input in samples
+     * @param kernel length of the kernel in samples
+     * @param rank rank of the block size
+     * @return number of channel pairs in one pass
+     */
+    size_t stream_pairs(const config_t *cfg, size_t channels, size_t in_length, size_t kernel, size_t rank);
+
+    /**
+     * Perform block-wise deconvolution of the input file with the reference using the uniformly
+     * partitioned overlap-save method. The input file is read from disk block by block and the
+     * impulse response is written to the output file as soon as it gets computed, so the memory
+     * usage does not depend on the length of the input file. The reference is split into partitions
+     * of the block size, so the size of transforms does not depend on the length of the reference.
+     * If the spectra of input blocks kept for all channels do not fit into the memory limit, the
+     * input file is read several times, each time for the next group of channels.
+     *
+     * @param cfg configuration
+     * @param ref reference sample, mono, sample rate should match the configuration
+     * @param norm_gain the normalization peak gain
+     * @param arena arena to take the buffers from, may be NULL, the buffers are allocated if the arena
+     *   has not enough free space
+     * @return status of operation
+     */
+    status_t deconvolve_stream(const config_t *cfg, const dspu::Sample &ref, float norm_gain, arena_t *arena);
+
+    /**
+     * Synthesize the test sweep and write it to the file block by block, so the memory
+     * usage does not depend on the length of the sweep.
+     *
+     * @param cfg configuration
+     * @param path path to the output file
+     * @param length length of one repetition in samples, the sweep is followed by zeros
+     * @param repeats number of back-to-back repetitions of the sweep
+     * @return status of operation
+     */
+    status_t synth_sweep_file(const config_t *cfg, const LSPString *path, size_t length, size_t repeats);
+
+    /**
+     * Load the audio file which contains several repetitions of the test signal and perform
+     * the synchronous averaging: the file is read by blocks in one pass and each block is
+     * added to the accumulator of one period long, so the memory usage does not depend
+     * on the number of repetitions. The file is resampled to the configured sample rate.
+     *
+     * @param cfg configuration
+     * @param path path to the audio file
+     * @param dst sample to store the average of all repetitions, one period long
+     * @param period period of the test signal in samples
+     * @param repeats maximum number of repetitions to average
+     * @return status of operation
+     */
+    status_t load_averaged(const config_t *cfg, const LSPString *path, dspu::Sample *dst, size_t period, size_t repeats);
+}
+
+#endif /* PRIVATE_STREAM_H_ */
@@ -22,10 +22,45 @@
 #ifndef PRIVATE_TOOL_H_
 #define PRIVATE_TOOL_H_
 
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <private/arena.h>
 #include <private/config.h>
+#include <private/stats.h>
 
 namespace room_raider
 {
+    struct ref_cache_t;
+
+    /**
+     * Load the reference file: read and average repetitions, resample to the sample rate of
+     * the configuration and apply the envelope of the inverse filter if necessary
+     * @param cfg configuration
+     * @param path path to the reference file
+     * @param ref sample to store the reference
+     * @param stats statistics
+     * @param threads maximum number of threads to resample the reference
+     * @return status of operation
+     */
+    status_t load_reference(const config_t *cfg, const LSPString *path, dspu::Sample *ref, stats_t *stats, size_t threads);
+
+    /**
+     * Check the configuration parsed from the command line
+     * @param cfg configuration
+     * @return status of operation
+     */
+    status_t check_config(const config_t *cfg);
+
+    /**
+     * Run the operating mode selected by the configuration
+     * @param cfg configuration
+     * @param stats statistics
+     * @param cache cache of references shared between jobs, may be NULL
+     * @param arena arena to take the memory of the job from, may be NULL
+     * @return status of operation
+     */
+    status_t process(config_t *cfg, stats_t *stats, ref_cache_t *cache, arena_t *arena);
+
     int main(int argc, const char **argv);
 }
 
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_WRITER_H_
+#define PRIVATE_WRITER_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/mm/OutAudioFileStream.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <private/arena.h>
+#include <private/config.h>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Block-wise audio file writer. The block is encoded and written to the file by the
+     * background thread while the next block is being prepared, so encoding of the output
+     * overlaps with the computation. The thread is started once when the file is opened
+     * and takes the submitted blocks one by one until the file is closed.
+     */
+    typedef struct writer_t
+    {
+        mm::OutAudioFileStream  sStream;        // Output stream
+        ipc::Thread            *pThread;        // Thread which writes the submitted blocks, NULL if writing synchronously
+        ipc::Mutex              sLock;          // Lock to pass blocks to the thread
+        size_t                  nChannels;      // Number of channels
+        size_t                  nCapacity;      // Capacity of each buffer in frames
+        size_t                  nCurrent;       // Index of the buffer being filled
+        float                  *vBuffers[2];    // Buffers of interleaved frames
+        const float            *pPending;       // Frames submitted to the thread, NULL when the thread is idle
+        size_t                  nPending;       // Number of frames submitted to the thread
+        bool                    bClose;         // The thread should exit when idle
+        status_t                nStatus;        // Status of the last write
+        arena_t                *pArena;         // Arena the buffers have been taken from, NULL if allocated
+        size_t                  nMark;          // Used size of the arena before the buffers have been taken
+        uint8_t                *pData;          // Allocated data
+    } writer_t;
+
+    /**
+     * Initialize the writer
+     * @param w writer
+     */
+    void init_writer(writer_t *w);
+
+    /**
+     * Create the output file and allocate buffers of the writer
+     * @param w writer
+     * @param path path to the output file
+     * @param channels number of channels
+     * @param srate sample rate
+     * @param frames number of frames that will be written
+     * @param format sample format of the file, one of sample_format_t
+     * @param container container of the file, one of container_t
+     * @param capacity capacity of the block in frames
+     * @param arena arena to take buffers from, buffers are allocated if the arena is NULL or has not
+     *   enough free space
+     * @return status of operation
+     */
+    status_t open_writer(writer_t *w, const LSPString *path, size_t channels, size_t srate, wssize_t frames,
+        size_t format, size_t container, size_t capacity, arena_t *arena);
+
+    /**
+     * Get the buffer to fill with the next block of interleaved frames, the buffer
+     * holds up to w->nCapacity frames
+     * @param w writer
+     * @return buffer
+     */
+    float *writer_buffer(writer_t *w);
+
+    /**
+     * Submit the block stored in the buffer returned by writer_buffer() for writing. The call
+     * waits until the previous block has been written and starts writing the new one
+     * in background.
+     * @param w writer
+     * @param frames number of frames in the block
+     * @return status of operation, including status of writing the previous block
+     */
+    status_t writer_submit(writer_t *w, size_t frames);
+
+    /**
+     * Wait until all submitted blocks are written, close the file and free allocated memory
+     * or return it to the arena
+     * @param w writer
+     * @return status of operation, including status of writing the last block
+     */
+    status_t close_writer(writer_t *w);
+
+    /**
+     * Save the part of the sample to the file in the output format specified by the configuration
+     * @param cfg configuration
+     * @param src source sample
+     * @param first index of the first sample to save
+     * @param length number of samples to save
+     * @param path path to the file
+     * @param arena arena to take buffers from, may be NULL
+     * @return status of operation
+     */
+    status_t save_window(const config_t *cfg, const dspu::Sample &src, size_t first, size_t length, const LSPString *path,
+        arena_t *arena);
+
+    /**
+     * Compute the size of the arena required by save_window()
+     * @param channels number of channels
+     * @return size of the arena in bytes
+     */
+    size_t writer_arena_size(size_t channels);
+}
+
+#endif /* PRIVATE_WRITER_H_ */
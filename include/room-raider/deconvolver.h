@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ROOM_RAIDER_DECONVOLVER_H_
+#define ROOM_RAIDER_DECONVOLVER_H_
+
+#include <room-raider/version.h>
+
+#include <stddef.h>
+
+namespace room_raider
+{
+    struct kernel_t;
+    struct route_t;
+    struct arena_t;
+
+    /**
+     * Status codes returned by the deconvolver
+     */
+    enum deconv_status_t
+    {
+        DECONV_OK               = 0,    // Success
+        DECONV_BAD_ARGUMENTS    = 1,    // Invalid arguments were passed to the method
+        DECONV_BAD_STATE        = 2,    // The deconvolver has not been initialized
+        DECONV_OVERFLOW         = 3,    // The input is longer than the maximum length set on initialization
+        DECONV_NO_MEM           = 4,    // Not enough memory
+        DECONV_FAILED           = 5     // Any other failure
+    };
+
+    /**
+     * Deconvolver of many captures with the same reference. The spectrum of the reference
+     * is computed and the aligned memory is reserved once on initialization and kept between
+     * calls, so each call only transforms the input. Signals are passed as arrays of pointers
+     * to the samples of each channel, methods return one of the deconv_status_t codes.
+     */
+    class ROOM_RAIDER_PUBLIC Deconvolver
+    {
+        private:
+            Deconvolver(const Deconvolver &);
+            Deconvolver & operator = (const Deconvolver &);
+
+        private:
+            size_t                  nMaxLength;     // Maximum length of the input
+            size_t                  nChannels;      // Number of input channels
+            size_t                  nThreads;       // Maximum number of worker threads
+            size_t                  nKernels;       // Number of kernels, one per reference channel
+            kernel_t               *vKernels;       // Kernel spectra
+            const kernel_t        **vList;          // List of kernels passed to the deconvolution
+            route_t                *vRoutes;        // Routes, one per each input channel
+            arena_t                *pArena;         // Arena with buffers of the workers
+
+        public:
+            explicit Deconvolver();
+            ~Deconvolver();
+
+        public:
+            /**
+             * Initialize the deconvolver. The mono reference is applied to all input channels,
+             * the reference with the same number of channels as the input is applied channel by channel.
+             * @param reference channels of the reference, are not used after initialization
+             * @param ref_channels number of reference channels
+             * @param ref_length length of the reference in samples
+             * @param max_length maximum length of the input in samples
+             * @param channels number of input channels
+             * @param threads maximum number of worker threads
+             * @return DECONV_OK on success, DECONV_BAD_ARGUMENTS if any of the arguments is invalid,
+             *   DECONV_NO_MEM if there is not enough memory
+             */
+            int             init(const float * const *reference, size_t ref_channels, size_t ref_length,
+                                 size_t max_length, size_t channels, size_t threads = 1);
+
+            /**
+             * Deconvolve the input with the reference. The output channel contains the impulse response of the
+             * input channel starting at the origin of time, normalized to the unit peak.
+             * @param input channels of the input, the configured number of channels
+             * @param length length of the input in samples, not greater than the configured maximum length
+             * @param output channels of the output, the same number as the input channels
+             * @param out_length length of the output in samples, the impulse response is written up to it
+             * @return DECONV_OK on success, DECONV_BAD_ARGUMENTS if any of the arguments is invalid,
+             *   DECONV_BAD_STATE if the deconvolver has not been initialized, DECONV_OVERFLOW if the input
+             *   is longer than the maximum length, DECONV_NO_MEM if there is not enough memory
+             */
+            int             process(const float * const *input, size_t length, float * const *output, size_t out_length);
+
+            /**
+             * Destroy the deconvolver and free allocated memory
+             */
+            void            destroy();
+
+        public:
+            inline size_t   max_length() const      { return nMaxLength;    }
+            inline size_t   channels() const        { return nChannels;     }
+    };
+
+}
+
+#endif /* ROOM_RAIDER_DECONVOLVER_H_ */
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ROOM_RAIDER_VERSION_H_
+#define ROOM_RAIDER_VERSION_H_
+
+#define ROOM_RAIDER_MAJOR           0
+#define ROOM_RAIDER_MINOR           5
+#define ROOM_RAIDER_MICRO           4
+
+// Public headers do not depend on headers of other libraries, so the modifiers are defined here
+#if defined(_WIN32) || defined(__CYGWIN__)
+    #define ROOM_RAIDER_EXPORT_MODIFIER     __declspec(dllexport)
+    #define ROOM_RAIDER_IMPORT_MODIFIER     __declspec(dllimport)
+#else
+    #define ROOM_RAIDER_EXPORT_MODIFIER     __attribute__((visibility("default")))
+    #define ROOM_RAIDER_IMPORT_MODIFIER
+#endif
+
+#if defined(ROOM_RAIDER_PUBLISHER)
+    #define ROOM_RAIDER_PUBLIC      ROOM_RAIDER_EXPORT_MODIFIER
+#elif defined(ROOM_RAIDER_BUILTIN) || defined(LSP_IDE_DEBUG)
+    #define ROOM_RAIDER_PUBLIC
+#else
+    #define ROOM_RAIDER_PUBLIC      ROOM_RAIDER_IMPORT_MODIFIER
+#endif
+
+#endif /* ROOM_RAIDER_VERSION_H_ */
@@ -24,6 +24,9 @@ ARTIFACT_NAME               = room-raider
 ARTIFACT_DESC               = Room-Raider - a tool for performing off-line impulse response capture of the room
 ARTIFACT_VERSION            = 0.5.3
 
+# Public headers installed with the library
+ARTIFACT_HEADERS            = room-raider
+
 #------------------------------------------------------------------------------
 # Plugin dependencies
 # List of dependencies
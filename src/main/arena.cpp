@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+
+#include <private/arena.h>
+
+#ifdef PLATFORM_LINUX
+    #include <sys/mman.h>
+#endif /* PLATFORM_LINUX */
+
+#define ARENA_ALIGN                 0x40        // Alignment of slices, the cache line
+#define HUGE_PAGE_SIZE              0x200000    // Size of the huge page on most of architectures
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    static inline size_t align_bytes(size_t bytes, size_t align)
+    {
+        return (bytes + align - 1) & ~(align - 1);
+    }
+
+    void init_arena(arena_t *a, bool huge_pages)
+    {
+        a->nCapacity    = 0;
+        a->nUsed        = 0;
+        a->bHugePages   = huge_pages;
+        a->vData        = NULL;
+        a->pData        = NULL;
+    }
+
+    size_t arena_size(size_t bytes)
+    {
+        return align_bytes(bytes, ARENA_ALIGN);
+    }
+
+    status_t reserve_arena(arena_t *a, size_t bytes)
+    {
+        if (bytes <= a->nCapacity)
+            return STATUS_OK;
+        if (a->nUsed > 0)
+            return STATUS_BAD_STATE;
+
+        // Huge pages require the memory aligned to the page boundary
+        size_t align    = ARENA_ALIGN;
+    #if defined(PLATFORM_LINUX) && defined(MADV_HUGEPAGE)
+        if ((a->bHugePages) && (bytes >= HUGE_PAGE_SIZE))
+        {
+            align           = HUGE_PAGE_SIZE;
+            bytes           = align_bytes(bytes, HUGE_PAGE_SIZE);
+        }
+    #endif /* MADV_HUGEPAGE */
+
+        uint8_t *pData  = NULL;
+        uint8_t *ptr    = alloc_aligned<uint8_t>(pData, bytes, align);
+        if (ptr == NULL)
+            return STATUS_NO_MEM;
+
+    #if defined(PLATFORM_LINUX) && defined(MADV_HUGEPAGE)
+        // The advice is optional, the memory is usable even if it is rejected
+        if ((align == HUGE_PAGE_SIZE) && (madvise(ptr, bytes, MADV_HUGEPAGE) != 0))
+            lsp_debug("arena: huge pages are not available for %d bytes", int(bytes));
+    #endif /* MADV_HUGEPAGE */
+
+        destroy_arena(a);
+        a->nCapacity    = bytes;
+        a->vData        = ptr;
+        a->pData        = pData;
+
+        return STATUS_OK;
+    }
+
+    void *arena_alloc(arena_t *a, size_t bytes)
+    {
+        bytes           = arena_size(bytes);
+        if (bytes > a->nCapacity - a->nUsed)
+            return NULL;
+
+        void *ptr       = &a->vData[a->nUsed];
+        a->nUsed       += bytes;
+        return ptr;
+    }
+
+    void rewind_arena(arena_t *a, size_t mark)
+    {
+        if (mark < a->nUsed)
+            a->nUsed        = mark;
+    }
+
+    void reset_arena(arena_t *a)
+    {
+        a->nUsed        = 0;
+    }
+
+    void destroy_arena(arena_t *a)
+    {
+        if (a->pData != NULL)
+            free_aligned(a->pData);
+
+        a->nCapacity    = 0;
+        a->nUsed        = 0;
+        a->vData        = NULL;
+        a->pData        = NULL;
+    }
+}
@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/InSequence.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+#include <private/batch.h>
+#include <private/cache.h>
+#include <private/dsp.h>
+#include <private/resample.h>
+#include <private/writer.h>
+
+#include <new>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Single deconvolution job
+     */
+    typedef struct job_t
+    {
+        LSPString                   sInFile;        // Input file
+        LSPString                   sReference;     // Reference file
+        LSPString                   sOutFile;       // Output file
+        size_t                      nLine;          // Line number in the manifest
+    } job_t;
+
+    /**
+     * Batch processing state shared between worker threads
+     */
+    typedef struct batch_t
+    {
+        const config_t             *pConfig;        // Configuration
+        stats_t                    *pStats;         // Statistics
+        float                       fNormGain;      // Normalization gain
+        size_t                      nThreads;       // Number of threads for each job
+        lltl::parray<job_t>         vJobs;          // List of jobs
+        ref_cache_t                 sCache;         // References and their kernels shared between jobs
+        size_t                      nNext;          // Next job to process
+        size_t                      nFailed;        // Number of failed jobs
+        status_t                    nStatus;        // Status of the first failed job
+        ipc::Mutex                  sJobLock;       // Lock to fetch next job
+    } batch_t;
+
+    static void destroy_batch(batch_t *b)
+    {
+        for (size_t i=0, n=b->vJobs.size(); i<n; ++i)
+        {
+            job_t *j = b->vJobs.uget(i);
+            if (j != NULL)
+                delete j;
+        }
+        b->vJobs.flush();
+
+        destroy_ref_cache(&b->sCache);
+    }
+
+    static bool parse_field(LSPString *dst, const LSPString *line, ssize_t first, ssize_t last)
+    {
+        if (!dst->set(line, first, last))
+            return false;
+        dst->trim();
+        return !dst->is_empty();
+    }
+
+    static status_t parse_manifest(batch_t *b, const LSPString *path)
+    {
+        io::InSequence is;
+        status_t res = is.open(path, "UTF-8");
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "Could not open manifest file: error code=%d\n", int(res));
+            return res;
+        }
+
+        LSPString line;
+        for (size_t nline = 1; (res = is.read_line(&line, true)) == STATUS_OK; ++nline)
+        {
+            // Skip empty lines and comments
+            line.trim();
+            if ((line.is_empty()) || (line.first() == '#'))
+                continue;
+
+            // Split the line into fields: input, reference, output
+            ssize_t s1  = line.index_of(',');
+            ssize_t s2  = (s1 >= 0) ? line.index_of(s1 + 1, ',') : -1;
+            if ((s2 < 0) || (line.index_of(s2 + 1, ',') >= 0))
+            {
+                fprintf(stderr, "Manifest line %d: expected three fields: input, reference, output\n", int(nline));
+                res     = STATUS_BAD_FORMAT;
+                break;
+            }
+
+            job_t *j    = new (std::nothrow) job_t;
+            if ((j == NULL) || (!b->vJobs.add(j)))
+            {
+                if (j != NULL)
+                    delete j;
+                res     = STATUS_NO_MEM;
+                break;
+            }
+
+            j->nLine    = nline;
+            if ((!parse_field(&j->sInFile, &line, 0, s1)) ||
+                (!parse_field(&j->sReference, &line, s1 + 1, s2)) ||
+                (!parse_field(&j->sOutFile, &line, s2 + 1, line.length())))
+            {
+                fprintf(stderr, "Manifest line %d: empty file name\n", int(nline));
+                res     = STATUS_BAD_FORMAT;
+                break;
+            }
+        }
+
+        is.close();
+        return (res == STATUS_EOF) ? STATUS_OK : res;
+    }
+
+    /**
+     * Acquire the reference from the cache and get the kernel of required transform size from the
+     * storage of the reference. The reference and it's kernels are computed only once for all jobs
+     * that share them, the kernel and the reference should be released with put_kernel().
+     */
+    static status_t get_kernel(batch_t *b, const LSPString *path, size_t in_length, ref_entry_t **entry, stored_kernel_t **kernel)
+    {
+        status_t res    = acquire_reference(&b->sCache, b->pConfig, path, b->pStats, b->nThreads, entry);
+        if (res != STATUS_OK)
+            return res;
+
+        // Batch jobs expect the reference to be mono
+        const dspu::Sample &ref = (*entry)->sSample;
+        if (ref.channels() == 1)
+        {
+            size_t radix    = 1;
+            size_t rank     = deconv_rank(in_length, ref.length(), &radix);
+            res             = acquire_kernel(b->pConfig, &(*entry)->sKernels, ref, 0, radix, rank, 0, kernel);
+        }
+        else
+            res             = STATUS_UNSUPPORTED_FORMAT;
+
+        if (res != STATUS_OK)
+        {
+            release_reference(&b->sCache, *entry);
+            *entry          = NULL;
+        }
+
+        return res;
+    }
+
+    static void put_kernel(batch_t *b, ref_entry_t *entry, stored_kernel_t *kernel)
+    {
+        release_kernel(&entry->sKernels, kernel);
+        release_reference(&b->sCache, entry);
+    }
+
+    /**
+     * Deconvolve the input with the kernel, then normalize, truncate and save the result
+     */
+    static status_t deconvolve_job(batch_t *b, const job_t *j, const dspu::Sample &in, const kernel_t *kernel, arena_t *arena)
+    {
+        status_t res;
+        const config_t *cfg = b->pConfig;
+        dspu::Sample out;       // Sample for output
+
+        // Initialize output sample
+        // We keep the output (Impulse Response) length the same as the longest recording.
+        size_t length   = lsp_max(in.length(), kernel->nLength);
+        if (!out.init(in.channels(), length, length))
+        {
+            fprintf(stderr, "Job at line %d: could not initialize output sample\n", int(j->nLine));
+            return STATUS_NO_MEM;
+        }
+        out.set_sample_rate(cfg->nSampleRate);
+
+        // Reserve the memory for the stage with the largest footprint, the arena of the worker
+        // grows only if the job needs more memory than all previous jobs
+        size_t footprint = lsp_max(
+            lsp_max(deconv_arena_size(kernel->nRadix, kernel->nRank, 1, b->nThreads),
+                ir_length_arena_size(cfg, out.channels(), length)),
+            writer_arena_size(out.channels()));
+        if ((res = reserve_arena(arena, footprint)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not reserve memory: error code=%d\n", int(j->nLine), int(res));
+            return res;
+        }
+
+        // Deconvolution and normalization
+        if ((res = deconvolve(in, kernel, out, b->nThreads, 0, arena)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not deconvolve: error code=%d\n", int(j->nLine), int(res));
+            return res;
+        }
+        normalize(&out, b->fNormGain, cfg->nNormalize);
+
+        // Truncate the impulse response and save it to output
+        size_t keep     = length;
+        if ((res = estimate_ir_length(cfg, out, 0, length, &keep, arena)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not estimate the length of impulse response: error code=%d\n", int(j->nLine), int(res));
+            return res;
+        }
+
+        if ((res = save_window(cfg, out, 0, keep, &j->sOutFile, arena)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not write output audio file\n", int(j->nLine));
+            return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t process_job(batch_t *b, const job_t *j, arena_t *arena)
+    {
+        status_t res;
+        const config_t *cfg = b->pConfig;
+        dspu::Sample in;        // Sample for input
+
+        // Read the input file and resample it to desired sample rate
+        if ((res = in.load(&j->sInFile)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not read input audio file: error code=%d\n", int(j->nLine), int(res));
+            return res;
+        }
+        if ((res = resample(&in, cfg->nSampleRate, b->nThreads)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not resample input audio file content: error code=%d\n", int(j->nLine), int(res));
+            return res;
+        }
+
+        // Obtain the kernel
+        ref_entry_t *entry      = NULL;
+        stored_kernel_t *kernel = NULL;
+        if ((res = get_kernel(b, &j->sReference, in.length(), &entry, &kernel)) != STATUS_OK)
+        {
+            fprintf(stderr, "Job at line %d: could not prepare reference: error code=%d\n", int(j->nLine), int(res));
+            return res;
+        }
+
+        res         = deconvolve_job(b, j, in, &kernel->sKernel, arena);
+        put_kernel(b, entry, kernel);
+
+        return res;
+    }
+
+    static status_t batch_worker(void *arg)
+    {
+        batch_t *b  = static_cast<batch_t *>(arg);
+
+        dsp::context_t ctx;
+        dsp::start(&ctx);
+
+        // The memory of the worker is reserved once and reused by all it's jobs
+        arena_t arena;
+        init_arena(&arena, b->pConfig->bHugePages);
+
+        while (true)
+        {
+            // Fetch the next job
+            b->sJobLock.lock();
+            size_t index    = b->nNext++;
+            b->sJobLock.unlock();
+
+            if (index >= b->vJobs.size())
+                break;
+
+            status_t res    = process_job(b, b->vJobs.uget(index), &arena);
+            reset_arena(&arena);
+            if (res != STATUS_OK)
+            {
+                b->sJobLock.lock();
+                if ((b->nFailed++) == 0)
+                    b->nStatus      = res;
+                b->sJobLock.unlock();
+            }
+        }
+
+        destroy_arena(&arena);
+        dsp::finish(&ctx);
+
+        return STATUS_OK;
+    }
+
+    status_t deconvolve_batch(const config_t *cfg, stats_t *stats, float norm_gain)
+    {
+        batch_t b;
+        b.pConfig       = cfg;
+        b.pStats        = stats;
+        b.fNormGain     = norm_gain;
+        b.nThreads      = 1;
+        b.nNext         = 0;
+        b.nFailed       = 0;
+        b.nStatus       = STATUS_OK;
+        init_ref_cache(&b.sCache, lsp_max(cfg->nServeCache, ssize_t(0)));
+
+        status_t res    = parse_manifest(&b, &cfg->sBatch);
+        if (res != STATUS_OK)
+        {
+            destroy_batch(&b);
+            return res;
+        }
+
+        // Jobs are processed in parallel, the rest of threads is used for processing channels of each job
+        size_t nJobs    = b.vJobs.size();
+        size_t nThreads = select_threads(cfg, size_t(-1));
+        size_t nWorkers = select_threads(cfg, nJobs);
+        b.nThreads      = lsp_max(nThreads / nWorkers, size_t(1));
+
+        lsp_debug("batch: jobs=%d, workers=%d, threads per job=%d", int(nJobs), int(nWorkers), int(b.nThreads));
+
+        lltl::parray<ipc::Thread> threads;
+        for (size_t i=0; i<nWorkers; ++i)
+        {
+            ipc::Thread *t  = new (std::nothrow) ipc::Thread(batch_worker, &b);
+            if (t == NULL)
+                break;
+            if ((!threads.add(t)) || (t->start() != STATUS_OK))
+            {
+                threads.premove(t);
+                delete t;
+                break;
+            }
+        }
+
+        // If no threads have been started, process jobs in the calling thread
+        if (threads.size() <= 0)
+            batch_worker(&b);
+
+        for (size_t i=0, n=threads.size(); i<n; ++i)
+        {
+            ipc::Thread *t  = threads.uget(i);
+            t->join();
+            delete t;
+        }
+        threads.flush();
+
+        // The standard output is left for the statistics report
+        fprintf(stderr, "Processed %d jobs, %d failed\n", int(nJobs), int(b.nFailed));
+
+        res             = b.nStatus;
+        destroy_batch(&b);
+
+        return res;
+    }
+}
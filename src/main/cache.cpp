@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/io/File.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/cache.h>
+#include <private/tool.h>
+
+#include <new>
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    static void destroy_entry(ref_entry_t *e)
+    {
+        destroy_kernel_store(&e->sKernels);
+        e->sSample.destroy();
+        delete e;
+    }
+
+    static void init_entry(ref_entry_t *e, const config_t *cfg, const io::fattr_t *attr)
+    {
+        e->nStatus      = STATUS_OK;
+        e->nSize        = attr->size;
+        e->nModified    = attr->mtime;
+        e->nSampleRate  = cfg->nSampleRate;
+        e->nSweepType   = cfg->nSweepType;
+        e->fStartFreq   = cfg->fStartFreq;
+        e->fEndFreq     = cfg->fEndFreq;
+        e->fSweepLength = cfg->fSweepLength;
+        e->nRepeats     = cfg->nRepeats;
+        e->bRegularize  = cfg->bRegularize;
+        e->fRegLevel    = cfg->fRegLevel;
+        e->nRefs        = 1;
+        e->bStale       = false;
+    }
+
+    static bool same_file(const ref_entry_t *e, const LSPString *path, const io::fattr_t *attr)
+    {
+        return (e->sPath.equals(path)) &&
+            (e->nSize == attr->size) &&
+            (e->nModified == attr->mtime);
+    }
+
+    static bool same_settings(const ref_entry_t *e, const config_t *cfg)
+    {
+        return (e->nSampleRate == cfg->nSampleRate) &&
+            (e->nSweepType == cfg->nSweepType) &&
+            (e->fStartFreq == cfg->fStartFreq) &&
+            (e->fEndFreq == cfg->fEndFreq) &&
+            (e->fSweepLength == cfg->fSweepLength) &&
+            (e->nRepeats == cfg->nRepeats) &&
+            (e->bRegularize == cfg->bRegularize) &&
+            ((!cfg->bRegularize) || (e->fRegLevel == cfg->fRegLevel));
+    }
+
+    /**
+     * Find the matching entry and acquire it, should be called with the lock held
+     */
+    static ref_entry_t *find_entry(ref_cache_t *cache, const config_t *cfg, const LSPString *path, const io::fattr_t *attr)
+    {
+        for (size_t i=0, n=cache->vEntries.size(); i<n; ++i)
+        {
+            ref_entry_t *e  = cache->vEntries.uget(i);
+            if ((!e->bStale) && (same_file(e, path, attr)) && (same_settings(e, cfg)))
+            {
+                ++e->nRefs;
+                e->nLastUse     = ++cache->nClock;
+                return e;
+            }
+        }
+
+        return NULL;
+    }
+
+    /**
+     * Remove entries of the file which has been changed since they have been loaded,
+     * entries still in use are removed when released. Should be called with the lock held
+     */
+    static void drop_outdated(ref_cache_t *cache, const LSPString *path, const io::fattr_t *attr)
+    {
+        for (size_t i=0; i<cache->vEntries.size(); )
+        {
+            ref_entry_t *e  = cache->vEntries.uget(i);
+            if ((!e->sPath.equals(path)) || (same_file(e, path, attr)))
+            {
+                ++i;
+                continue;
+            }
+
+            e->bStale       = true;
+            if (e->nRefs > 0)
+            {
+                ++i;
+                continue;
+            }
+
+            cache->vEntries.premove(e);
+            destroy_entry(e);
+        }
+    }
+
+    /**
+     * Destroy the least recently used entries which are not in use while their number
+     * exceeds the capacity of the cache. Should be called with the lock held
+     */
+    static void evict_unused(ref_cache_t *cache)
+    {
+        while (true)
+        {
+            ref_entry_t *lru    = NULL;
+            size_t unused       = 0;
+            for (size_t i=0, n=cache->vEntries.size(); i<n; ++i)
+            {
+                ref_entry_t *e      = cache->vEntries.uget(i);
+                if (e->nRefs > 0)
+                    continue;
+                ++unused;
+                if ((lru == NULL) || (e->nLastUse < lru->nLastUse))
+                    lru                 = e;
+            }
+
+            if (unused <= cache->nCapacity)
+                break;
+
+            cache->vEntries.premove(lru);
+            destroy_entry(lru);
+        }
+    }
+
+    void init_ref_cache(ref_cache_t *cache, size_t capacity)
+    {
+        cache->nCapacity    = capacity;
+        cache->nClock       = 0;
+    }
+
+    status_t acquire_reference(ref_cache_t *cache, const config_t *cfg, const LSPString *path, stats_t *stats,
+        size_t threads, ref_entry_t **entry)
+    {
+        io::fattr_t attr;
+        status_t res = io::File::stat(path, &attr);
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "Could not read reference audio file: error code=%d\n", int(res));
+            return res;
+        }
+
+        // Lookup for the reference or put the new entry which is held locked until it is loaded
+        cache->sLock.lock();
+        ref_entry_t *e  = find_entry(cache, cfg, path, &attr);
+        if (e != NULL)
+        {
+            cache->sLock.unlock();
+
+            // Wait until the reference is loaded by the job which has put it into the cache
+            e->sLoading.lock();
+            res             = e->nStatus;
+            e->sLoading.unlock();
+            if (res != STATUS_OK)
+            {
+                release_reference(cache, e);
+                return res;
+            }
+
+            *entry          = e;
+            return STATUS_OK;
+        }
+
+        if ((e = new (std::nothrow) ref_entry_t) == NULL)
+        {
+            cache->sLock.unlock();
+            return STATUS_NO_MEM;
+        }
+        if ((!e->sPath.set(path)) || (!cache->vEntries.add(e)))
+        {
+            cache->sLock.unlock();
+            delete e;
+            return STATUS_NO_MEM;
+        }
+        init_entry(e, cfg, &attr);
+        init_kernel_store(&e->sKernels);
+        e->nLastUse     = ++cache->nClock;
+        e->sLoading.lock();
+        drop_outdated(cache, path, &attr);
+        evict_unused(cache);
+        cache->sLock.unlock();
+
+        // Load the reference without holding the lock of the cache, so jobs with other references are not blocked
+        res             = load_reference(cfg, path, &e->sSample, stats, threads);
+        e->nStatus      = res;
+        e->sLoading.unlock();
+        if (res != STATUS_OK)
+        {
+            // The failed entry is not matched by other jobs anymore and is removed when released
+            cache->sLock.lock();
+            e->bStale       = true;
+            cache->sLock.unlock();
+            release_reference(cache, e);
+            return res;
+        }
+
+        *entry          = e;
+        return STATUS_OK;
+    }
+
+    void release_reference(ref_cache_t *cache, ref_entry_t *entry)
+    {
+        cache->sLock.lock();
+        entry->nLastUse = ++cache->nClock;
+        if (((--entry->nRefs) == 0) && (entry->bStale))
+        {
+            cache->vEntries.premove(entry);
+            destroy_entry(entry);
+        }
+        else
+            evict_unused(cache);
+        cache->sLock.unlock();
+    }
+
+    void destroy_ref_cache(ref_cache_t *cache)
+    {
+        for (size_t i=0, n=cache->vEntries.size(); i<n; ++i)
+        {
+            ref_entry_t *e  = cache->vEntries.uget(i);
+            if (e != NULL)
+                destroy_entry(e);
+        }
+        cache->vEntries.flush();
+    }
+}
@@ -48,19 +48,43 @@ namespace room_raider
 
     static const option_t options[] =
     {
+        { "-b",   "--batch",            false,     "Deconvolve all jobs listed in the manifest file" },
+        { "-bs",  "--block-size",       false,     "Block size (in samples) for streaming mode" },
+        { "-ch",  "--channels",         false,     "Comma-separated input channels to deconvolve (all by default)" },
         { "-d",   "--deconvolve",       true,      "Deconvolve the captured signal"             },
         { "-ef",  "--end-freq",         false,     "End frequency of the sine sweep"            },
         { "-g",   "--gain",             false,     "Gain (in dB) of the sine sweep"             },
         { "-h",   "--help",             true,      "Output this help message"                   },
+        { "-hm",  "--harmonics",        false,     "Highest order of harmonic distortion IR to extract" },
+        { "-hp",  "--huge-pages",       true,      "Back the memory of jobs with huge pages"    },
         { "-i",   "--in-file",          false,     "Input audio file"                           },
+        { "-iw",  "--ir-window",        false,     "Window of the impulse response to compute in ms: start:length" },
+        { "-if",  "--inverse-file",     false,     "Inverse filter audio file for the sine sweep" },
+        { "-j",   "--threads",          false,     "Number of worker threads (0 = all CPU cores)" },
+        { "-l",   "--ir-length",        false,     "Length of the impulse response in ms, or 'auto' to cut at the noise floor" },
+        { "-lr",  "--latency",          true,      "Report latency and alignment of output channels" },
+        { "-lrf", "--latency-file",     false,     "Latency report file (standard output by default)" },
+        { "-mm",  "--max-memory",       false,     "Maximum memory usage in MB (0 = unlimited)" },
+        { "-mx",  "--matrix",           true,      "Deconvolve each input channel with each reference channel" },
         { "-n",   "--normalize",        false,     "Set normalization mode"                     },
         { "-ng",  "--norm-gain",        false,     "Set normalization peak gain (in dB)"        },
         { "-o",   "--out-file",         false,     "Output audio file"                          },
+        { "-oc",  "--out-container",    false,     "Container of output files: wav, rf64, flac" },
+        { "-of",  "--out-format",       false,     "Sample format of output files: f32, s24, s16" },
         { "-r",   "--reference",        false,     "Reference audio file"                       },
+        { "-rg",  "--regularize",       false,     "Regularized inverse filtering with in-band regularization level in dB" },
+        { "-rm",  "--ref-map",          false,     "Comma-separated reference channel for each input channel" },
+        { "-rp",  "--repeats",          false,     "Number of back-to-back sine sweep repetitions" },
         { "-s",   "--sweep",            true,      "Produce sine sweep signal"                  },
         { "-sf",  "--start-freq",       false,     "Start frequency of the sine sweep"          },
         { "-sl",  "--sweep-length",     false,     "The length of the sweep in ms"              },
         { "-sr",  "--srate",            false,     "Sample rate of output files"                },
+        { "-st",  "--stream",           true,      "Deconvolve by blocks without loading input file" },
+        { "-sv",  "--serve",            false,     "Serve jobs received over the Unix socket at the path" },
+        { "-svc", "--serve-cache",      false,     "Maximum number of references kept by the server or batch when not in use" },
+        { "-sw",  "--sweep-type",       false,     "Type of the sine sweep: linear, exp"        },
+        { "-sx",  "--stats",            false,     "Output processing statistics: none, json"   },
+        { "-sxf", "--stats-file",       false,     "Statistics file (standard output by default)" },
         { NULL, NULL, false, NULL }
     };
 
@@ -73,6 +97,38 @@ namespace room_raider
         { NULL,     0           }
     };
 
+    const cfg_flag_t sweep_type_flags[] =
+    {
+        { "linear", SWEEP_LINEAR },
+        { "lin",    SWEEP_LINEAR },
+        { "exp",    SWEEP_EXP    },
+        { NULL,     0            }
+    };
+
+    const cfg_flag_t stats_flags[] =
+    {
+        { "none",   STATS_NONE   },
+        { "json",   STATS_JSON   },
+        { NULL,     0            }
+    };
+
+    const cfg_flag_t sample_format_flags[] =
+    {
+        { "f32",    SAMPLE_F32   },
+        { "float",  SAMPLE_F32   },
+        { "s24",    SAMPLE_S24   },
+        { "s16",    SAMPLE_S16   },
+        { NULL,     0            }
+    };
+
+    const cfg_flag_t container_flags[] =
+    {
+        { "wav",    CONTAINER_WAV   },
+        { "rf64",   CONTAINER_RF64  },
+        { "flac",   CONTAINER_FLAC  },
+        { NULL,     0               }
+    };
+
     status_t print_usage(const char *name, bool fail)
     {
         LSPString buf, fmt;
@@ -209,6 +265,92 @@ namespace room_raider
         return STATUS_OK;
     }
 
+    status_t parse_cmdline_map(lltl::darray<size_t> *dst, const char *val, const char *parameter)
+    {
+        LSPString in, item;
+        if (!in.set_native(val))
+        {
+            fprintf(stderr, "Out of memory\n");
+            return STATUS_NO_MEM;
+        }
+
+        dst->flush();
+        for (ssize_t first = 0; first <= ssize_t(in.length()); )
+        {
+            ssize_t last    = in.index_of(first, ',');
+            if (last < 0)
+                last            = in.length();
+
+            ssize_t ivalue;
+            status_t res;
+            if (!item.set(&in, first, last))
+            {
+                fprintf(stderr, "Out of memory\n");
+                return STATUS_NO_MEM;
+            }
+            if ((res = parse_cmdline_int(&ivalue, item.get_native(), parameter)) != STATUS_OK)
+                return res;
+            if (ivalue < 0)
+            {
+                fprintf(stderr, "Bad '%s' value\n", parameter);
+                return STATUS_INVALID_VALUE;
+            }
+
+            size_t *v       = dst->add();
+            if (v == NULL)
+            {
+                fprintf(stderr, "Out of memory\n");
+                return STATUS_NO_MEM;
+            }
+            *v              = ivalue;
+            first           = last + 1;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t parse_cmdline_window(float *start, float *length, const char *val, const char *parameter)
+    {
+        LSPString in, item;
+        if (!in.set_native(val))
+        {
+            fprintf(stderr, "Out of memory\n");
+            return STATUS_NO_MEM;
+        }
+
+        ssize_t split   = in.index_of(':');
+        if (split < 0)
+        {
+            fprintf(stderr, "Bad '%s' value, should be start:length\n", parameter);
+            return STATUS_BAD_FORMAT;
+        }
+
+        status_t res;
+        if (!item.set(&in, 0, split))
+        {
+            fprintf(stderr, "Out of memory\n");
+            return STATUS_NO_MEM;
+        }
+        if ((res = parse_cmdline_float(start, item.get_native(), parameter)) != STATUS_OK)
+            return res;
+
+        if (!item.set(&in, split + 1))
+        {
+            fprintf(stderr, "Out of memory\n");
+            return STATUS_NO_MEM;
+        }
+        if ((res = parse_cmdline_float(length, item.get_native(), parameter)) != STATUS_OK)
+            return res;
+
+        if ((*start < 0.0f) || (*length <= 0.0f))
+        {
+            fprintf(stderr, "Bad '%s' value\n", parameter);
+            return STATUS_INVALID_VALUE;
+        }
+
+        return STATUS_OK;
+    }
+
     status_t parse_cmdline(config_t *cfg, int argc, const char **argv)
     {
         const char *cmd = argv[0], *val;
@@ -296,6 +438,31 @@ namespace room_raider
             }
             cfg->enMode     = M_DECONVOLVE;
         }
+        if ((val = options.get("--batch")) != NULL)
+        {
+            if (cfg->enMode != M_NONE)
+            {
+                fprintf(stderr, "Can not select batch mode\n");
+                return STATUS_NO_MEM;
+            }
+            cfg->enMode     = M_BATCH;
+            cfg->sBatch.set_native(val);
+        }
+        if ((val = options.get("--serve")) != NULL)
+        {
+            if (cfg->enMode != M_NONE)
+            {
+                fprintf(stderr, "Can not select server mode\n");
+                return STATUS_NO_MEM;
+            }
+            cfg->enMode     = M_SERVE;
+            cfg->sServe.set_native(val);
+        }
+        if ((val = options.get("--serve-cache")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nServeCache, val, "serve cache")) != STATUS_OK)
+                return res;
+        }
 
         if ((val = options.get("--in-file")) != NULL)
             cfg->sInFile.set_native(val);
@@ -328,11 +495,108 @@ namespace room_raider
             if ((res = parse_cmdline_float(&cfg->fSweepLength, val, "sweep length")) != STATUS_OK)
                 return res;
         }
+        if ((val = options.get("--sweep-type")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->nSweepType, "sweep type", val, sweep_type_flags)) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--harmonics")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nHarmonics, val, "harmonics")) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--repeats")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nRepeats, val, "repeats")) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--inverse-file")) != NULL)
+            cfg->sInverse.set_native(val);
         if ((val = options.get("--norm-gain")) != NULL)
         {
             if ((res = parse_cmdline_float(&cfg->fNormGain, val, "norm-gain")) != STATUS_OK)
                 return res;
         }
+        if ((val = options.get("--threads")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nThreads, val, "threads")) != STATUS_OK)
+                return res;
+        }
+        if (options.contains("--stream"))
+            cfg->bStream    = true;
+        if ((val = options.get("--block-size")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nBlockSize, val, "block size")) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--max-memory")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nMaxMemory, val, "max memory")) != STATUS_OK)
+                return res;
+        }
+        if (options.contains("--huge-pages"))
+            cfg->bHugePages = true;
+        if ((val = options.get("--stats")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->nStats, "stats", val, stats_flags)) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--stats-file")) != NULL)
+        {
+            cfg->sStatsFile.set_native(val);
+            if (cfg->nStats == STATS_NONE)
+                cfg->nStats     = STATS_JSON;
+        }
+        if ((val = options.get("--out-format")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->nOutFormat, "out format", val, sample_format_flags)) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--out-container")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->nOutContainer, "out container", val, container_flags)) != STATUS_OK)
+                return res;
+            // FLAC does not support floating-point samples
+            if ((cfg->nOutContainer == CONTAINER_FLAC) && (!options.contains("--out-format")))
+                cfg->nOutFormat = SAMPLE_S24;
+        }
+        if ((val = options.get("--regularize")) != NULL)
+        {
+            if ((res = parse_cmdline_float(&cfg->fRegLevel, val, "regularize")) != STATUS_OK)
+                return res;
+            cfg->bRegularize    = true;
+        }
+        if (options.contains("--latency"))
+            cfg->bLatency   = true;
+        if ((val = options.get("--latency-file")) != NULL)
+        {
+            cfg->sLatencyFile.set_native(val);
+            cfg->bLatency   = true;
+        }
+        if (options.contains("--matrix"))
+            cfg->bMatrix    = true;
+        if ((val = options.get("--ref-map")) != NULL)
+        {
+            if ((res = parse_cmdline_map(&cfg->vRefMap, val, "reference map")) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--channels")) != NULL)
+        {
+            if ((res = parse_cmdline_map(&cfg->vChannels, val, "channels")) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--ir-window")) != NULL)
+        {
+            if ((res = parse_cmdline_window(&cfg->fWindowStart, &cfg->fWindowLength, val, "IR window")) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--ir-length")) != NULL)
+        {
+            if (!strcmp(val, "auto"))
+                cfg->bIRAuto    = true;
+            else if ((res = parse_cmdline_float(&cfg->fIRLength, val, "IR length")) != STATUS_OK)
+                return res;
+        }
         if ((val = options.get("--normalize")) != NULL)
         {
             if ((res = parse_cmdline_enum(&cfg->nNormalize, "normalize", val, normalize_flags)) != STATUS_OK)
@@ -34,9 +34,30 @@ namespace room_raider
         fEndFreq        = 20000.0f;
         fGain           = 0.0f;
         fSweepLength    = 20.0f;
+        nSweepType      = SWEEP_LINEAR; // Linear sweep by default
+        nHarmonics      = 0;            // Do not extract harmonic distortion
+        nRepeats        = 1;            // Single sine sweep
 
         nNormalize      = NORM_NONE;    // No normalization by default
         fNormGain       = 0.0f;         // 0 dB gain by default
+
+        nThreads        = 0;            // Use all available CPU cores
+        bStream         = false;        // Load files into memory by default
+        nBlockSize      = 0;            // Automatically compute block size
+        nMaxMemory      = 0;            // Do not limit memory usage
+        bHugePages      = false;        // Use regular pages
+        nServeCache     = 8;            // Keep up to 8 unused references in the server
+        fIRLength       = 0.0f;         // Keep full length of the impulse response
+        bIRAuto         = false;        // Do not truncate the impulse response
+        bRegularize     = false;        // Use the matched filter
+        fRegLevel       = -60.0f;       // -60 dB in-band regularization
+        bMatrix         = false;        // Do not compute the IR matrix
+        fWindowStart    = 0.0f;         // The window starts at the origin of time
+        fWindowLength   = 0.0f;         // Compute the full impulse response
+        nStats          = STATS_NONE;   // Do not collect statistics
+        bLatency        = false;        // Do not report latency
+        nOutFormat      = SAMPLE_F32;   // Floating-point output by default
+        nOutContainer   = CONTAINER_WAV;// WAV output by default
     }
 
     config_t::~config_t()
@@ -53,13 +74,41 @@ namespace room_raider
         fEndFreq        = 20000.0f;
         fGain           = 0.0f;
         fSweepLength    = 20.0f;
+        nSweepType      = SWEEP_LINEAR;
+        nHarmonics      = 0;
+        nRepeats        = 1;
 
         nNormalize      = NORM_NONE;
         fNormGain       = 0.0f;
 
+        nThreads        = 0;
+        bStream         = false;
+        nBlockSize      = 0;
+        nMaxMemory      = 0;
+        bHugePages      = false;
+        nServeCache     = 8;
+        fIRLength       = 0.0f;
+        bIRAuto         = false;
+        bRegularize     = false;
+        fRegLevel       = -60.0f;
+        bMatrix         = false;
+        fWindowStart    = 0.0f;
+        fWindowLength   = 0.0f;
+        nStats          = STATS_NONE;
+        bLatency        = false;
+        nOutFormat      = SAMPLE_F32;
+        nOutContainer   = CONTAINER_WAV;
+
         sInFile.clear();
         sOutFile.clear();
         sReference.clear();
+        sBatch.clear();
+        sInverse.clear();
+        sServe.clear();
+        sStatsFile.clear();
+        sLatencyFile.clear();
+        vRefMap.flush();
+        vChannels.flush();
     }
 
 }
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <room-raider/deconvolver.h>
+#include <private/dsp.h>
+
+#include <new>
+
+namespace room_raider
+{
+    static bool init_dsp()
+    {
+        // Programs that embed the library do not have access to the DSP library
+        dsp::init();
+        return true;
+    }
+
+    static int public_status(status_t res)
+    {
+        switch (res)
+        {
+            case STATUS_OK:             return DECONV_OK;
+            case STATUS_BAD_ARGUMENTS:  return DECONV_BAD_ARGUMENTS;
+            case STATUS_BAD_STATE:      return DECONV_BAD_STATE;
+            case STATUS_OVERFLOW:       return DECONV_OVERFLOW;
+            case STATUS_NO_MEM:         return DECONV_NO_MEM;
+            default: break;
+        }
+        return DECONV_FAILED;
+    }
+
+    Deconvolver::Deconvolver()
+    {
+        nMaxLength      = 0;
+        nChannels       = 0;
+        nThreads        = 1;
+        nKernels        = 0;
+        vKernels        = NULL;
+        vList           = NULL;
+        vRoutes         = NULL;
+        pArena          = NULL;
+    }
+
+    Deconvolver::~Deconvolver()
+    {
+        destroy();
+    }
+
+    void Deconvolver::destroy()
+    {
+        if (vKernels != NULL)
+        {
+            for (size_t i=0; i<nKernels; ++i)
+                destroy_kernel(&vKernels[i]);
+            delete [] vKernels;
+            vKernels        = NULL;
+        }
+        if (vList != NULL)
+        {
+            delete [] vList;
+            vList           = NULL;
+        }
+        if (vRoutes != NULL)
+        {
+            delete [] vRoutes;
+            vRoutes         = NULL;
+        }
+        if (pArena != NULL)
+        {
+            destroy_arena(pArena);
+            delete pArena;
+            pArena          = NULL;
+        }
+
+        nMaxLength      = 0;
+        nChannels       = 0;
+        nThreads        = 1;
+        nKernels        = 0;
+    }
+
+    int Deconvolver::init(const float * const *reference, size_t ref_channels, size_t ref_length,
+        size_t max_length, size_t channels, size_t threads)
+    {
+        size_t nrefs    = ref_channels;
+        if ((reference == NULL) || (max_length <= 0) || (channels <= 0) || (nrefs <= 0) || (ref_length <= 0))
+            return DECONV_BAD_ARGUMENTS;
+        if ((nrefs != 1) && (nrefs != channels))
+            return DECONV_BAD_ARGUMENTS;
+
+        // The static initialization is performed only once, even if called from concurrent threads
+        static const bool dsp_ready = init_dsp();
+        if (!dsp_ready)
+            return DECONV_FAILED;
+
+        destroy();
+
+        // The transform is large enough for the longest input, shorter inputs are padded with zeros
+        size_t radix    = 1;
+        size_t rank     = deconv_rank(max_length, ref_length, &radix);
+        nThreads        = lsp_max(lsp_min(threads, (channels + 1) >> 1), size_t(1));
+
+        vKernels        = new (std::nothrow) kernel_t[nrefs];
+        vList           = new (std::nothrow) const kernel_t *[nrefs];
+        vRoutes         = new (std::nothrow) route_t[channels];
+        pArena          = new (std::nothrow) arena_t;
+        if ((vKernels == NULL) || (vList == NULL) || (vRoutes == NULL) || (pArena == NULL))
+        {
+            destroy();
+            return DECONV_NO_MEM;
+        }
+
+        nKernels        = nrefs;
+        init_arena(pArena, false);
+        for (size_t i=0; i<nrefs; ++i)
+        {
+            init_kernel(&vKernels[i]);
+            vList[i]        = &vKernels[i];
+        }
+        for (size_t i=0; i<channels; ++i)
+        {
+            vRoutes[i].nInput   = i;
+            vRoutes[i].nKernel  = (nrefs == 1) ? 0 : i;
+        }
+
+        // Compute the spectrum of the reference and reserve the arena once
+        status_t res    = STATUS_OK;
+        for (size_t i=0; (res == STATUS_OK) && (i < nrefs); ++i)
+            res             = (reference[i] != NULL) ?
+                build_kernel(&vKernels[i], reference[i], ref_length, radix, rank, NULL) : STATUS_BAD_ARGUMENTS;
+        if (res == STATUS_OK)
+            res             = reserve_arena(pArena, deconv_arena_size(radix, rank, nrefs, nThreads));
+        if (res != STATUS_OK)
+        {
+            destroy();
+            return public_status(res);
+        }
+
+        nMaxLength      = max_length;
+        nChannels       = channels;
+
+        return DECONV_OK;
+    }
+
+    int Deconvolver::process(const float * const *input, size_t length, float * const *output, size_t out_length)
+    {
+        if (vKernels == NULL)
+            return DECONV_BAD_STATE;
+        if ((input == NULL) || (output == NULL))
+            return DECONV_BAD_ARGUMENTS;
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            if ((input[i] == NULL) || (output[i] == NULL))
+                return DECONV_BAD_ARGUMENTS;
+        }
+        if (length > nMaxLength)
+            return DECONV_OVERFLOW;
+
+        status_t res    = deconvolve(input, nChannels, length, vList, nKernels, vRoutes, output, nChannels, out_length,
+            nThreads, 0, pArena);
+        return public_status(res);
+    }
+
+}
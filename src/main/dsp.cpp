@@ -22,218 +22,1744 @@
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/util/Oversampler.h>
 #include <lsp-plug.in/dsp-units/units.h>
-#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 #include <private/dsp.h>
+#include <private/fft.h>
+#include <private/stats.h>
+
+#include <new>
+
+#define SWEEP_BLOCK_SIZE            1024
+#define IR_BLOCK_TIME               10.0f       /* Duration of the block for IR energy estimation, ms */
+#define IR_NOISE_MARGIN             2.0         /* The IR is cut at the point 3 dB above the noise floor */
+#define REG_TRANSITION              (1.0 / 3.0) /* Width of the transition to out-of-band regularization, octaves */
+#define REG_OUT_OF_BAND             0.0         /* Out-of-band regularization relative to the peak power, dB */
+#define WINDOW_MIN_RANK             12          /* Minimum FFT rank of the partitioned deconvolution */
+#define STORED_KERNELS              4           /* Maximum number of unused kernels kept for each reference channel */
 
 namespace room_raider
 {
     using namespace lsp;
 
-    status_t synth_test_sweep(const config_t *cfg, dspu::Sample &out)
+    /**
+     * Wrap the phase to [-PI, PI), the phase should be not less than -PI
+     */
+    static inline float wrap_phase(double phase)
+    {
+        // The value is non-negative, so truncation works as floor but does not require function call
+        double x = phase + M_PI;
+        return float(x - double(int64_t(x * (0.5 / M_PI))) * (2.0 * M_PI) - M_PI);
+    }
+
+    /**
+     * Compute sine of the phase wrapped to [-PI, PI) in place. The argument is reduced to [-PI/2, PI/2]
+     * and then the odd Taylor polynomial up to x^15 is used, it's error is below the float precision.
+     * The loop has no branches and function calls, so it can be vectorized by the compiler.
+     */
+    static void sweep_sin(float *dst, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            // sin(x) = sin(PI - x) = sin(-PI - x)
+            float x     = dst[i];
+            x           = (x > float(M_PI_2)) ? float(M_PI) - x : x;
+            x           = (x < float(-M_PI_2)) ? float(-M_PI) - x : x;
+
+            float x2    = x * x;
+            dst[i]      = x * (1.0f + x2 * (-1.0f/6.0f + x2 * (1.0f/120.0f + x2 * (-1.0f/5040.0f +
+                          x2 * (1.0f/362880.0f + x2 * (-1.0f/39916800.0f + x2 * (1.0f/6227020800.0f +
+                          x2 * (-1.0f/1307674368000.0f))))))));
+        }
+    }
+
+    void synth_sweep(const config_t *cfg, float *dst, size_t first, size_t count, size_t srate)
+    {
+        double dDelta   = 1.0 / srate;
+        double dF1      = cfg->fStartFreq;
+        // Factor of 1000 to convert from milliseconds to seconds.
+        double dSlope   = 1000.0 * (double(cfg->fEndFreq) - dF1) / cfg->fSweepLength;
+        // Exponential Swept Sine spends equal time per octave, the rate is required only for it.
+        bool bExp       = cfg->nSweepType == SWEEP_EXP;
+        double dRate    = (bExp) ? exp_sweep_rate(cfg) : 1.0;
+        double dStep    = expm1(dDelta / dRate);
+
+        // The phase is computed exactly in double precision at the start of each block and wrapped.
+        // Inside the block we compute only the phase increment which is small, so the precision
+        // is kept and there is no error accumulation between blocks.
+        for (size_t off=0; off < count; off += SWEEP_BLOCK_SIZE)
+        {
+            float *buf      = &dst[off];
+            size_t n        = lsp_min(count - off, size_t(SWEEP_BLOCK_SIZE));
+            double dTime    = double(first + off) * dDelta;
+            double dPhase;
+
+            if (bExp)
+            {
+                // Phase is the integral of f1 * exp(t/L): 2*PI*f1*L*(exp(t/L) - 1), the increment
+                // over i samples is 2*PI*f1*L*exp(t/L)*(exp(i*dt/L) - 1)
+                double dScale   = 2.0 * M_PI * dF1 * dRate * exp(dTime / dRate);
+                dPhase          = dScale - 2.0 * M_PI * dF1 * dRate;
+                dPhase          = fmod(dPhase + M_PI, 2.0 * M_PI) - M_PI;
+
+                double d        = 0.0; // exp(i*dt/L) - 1
+                for (size_t i=0; i<n; ++i)
+                {
+                    buf[i]          = wrap_phase(dPhase + dScale * d);
+                    d              += (1.0 + d) * dStep;
+                }
+            }
+            else
+            {
+                // For linear chirp we use quadratic instantaneous phase, the increment over i samples
+                // is 2*PI*((s*t + f1)*i*dt + 0.5*s*(i*dt)^2)
+                dPhase          = 2.0 * M_PI * (0.5 * dSlope * dTime * dTime + dF1 * dTime);
+                dPhase          = fmod(dPhase + M_PI, 2.0 * M_PI) - M_PI;
+
+                double dW       = 2.0 * M_PI * (dSlope * dTime + dF1) * dDelta;
+                double dA       = M_PI * dSlope * dDelta * dDelta;
+                for (size_t i=0; i<n; ++i)
+                    buf[i]          = wrap_phase(dPhase + double(i) * (dW + dA * double(i)));
+            }
+
+            sweep_sin(buf, n);
+        }
+    }
+
+    status_t init_sweep_synth(sweep_synth_t *s, const config_t *cfg)
     {
+        s->pConfig          = cfg;
+        s->nOffset          = 0;
+        s->vBuffer          = NULL;
+        s->pData            = NULL;
+
         // A swept sine is a complex signal. Let's use oversampler to make sure we don't introduce too much aliasing.
-        dspu::Oversampler sOversampler;
-        if (!sOversampler.init())
+        if (!s->sOversampler.init())
             return STATUS_FAILED;
 
-        sOversampler.set_sample_rate(cfg->nSampleRate);
-        sOversampler.set_mode(dspu::OM_LANCZOS_8X3);
-        sOversampler.update_settings();
+        s->sOversampler.set_sample_rate(cfg->nSampleRate);
+        s->sOversampler.set_mode(dspu::OM_LANCZOS_8X3);
+        s->sOversampler.update_settings();
+
+        s->nOversampling    = s->sOversampler.get_oversampling();
+        s->nOverRate        = s->nOversampling * cfg->nSampleRate;
+        s->nLength          = size_t(dspu::millis_to_samples(s->nOverRate, cfg->fSweepLength)) / s->nOversampling;
+        // Scale with gain, but the maximum gain must be 1 to prevent clipping in the final file.
+        s->fGain            = lsp_min(dspu::db_to_gain(cfg->fGain), 1.0f);
+
+        // Allocate the buffer for one block of the oversampled chirp samples.
+        s->vBuffer          = alloc_aligned<float>(s->pData, SWEEP_BLOCK_SIZE * s->nOversampling);
+        if (s->vBuffer == NULL)
+        {
+            s->sOversampler.destroy();
+            return STATUS_NO_MEM;
+        }
+
+        return STATUS_OK;
+    }
+
+    size_t sweep_synth_process(sweep_synth_t *s, float *dst, size_t count)
+    {
+        count           = lsp_min(count, s->nLength - s->nOffset);
+
+        for (size_t done = 0; done < count; )
+        {
+            size_t n        = lsp_min(count - done, size_t(SWEEP_BLOCK_SIZE));
+            size_t nOver    = n * s->nOversampling;
+
+            synth_sweep(s->pConfig, s->vBuffer, s->nOffset * s->nOversampling, nOver, s->nOverRate);
+            dsp::mul_k2(s->vBuffer, s->fGain, nOver);
+            s->sOversampler.downsample(&dst[done], s->vBuffer, n);
+
+            s->nOffset     += n;
+            done           += n;
+        }
+
+        return count;
+    }
+
+    void destroy_sweep_synth(sweep_synth_t *s)
+    {
+        s->sOversampler.destroy();
+        if (s->pData != NULL)
+        {
+            free_aligned(s->pData);
+            s->pData        = NULL;
+        }
+        s->vBuffer      = NULL;
+    }
+
+    status_t synth_test_sweep(const config_t *cfg, dspu::Sample &out)
+    {
+        // We expect this to be mono.
+        if (out.channels() != 1)
+            return STATUS_FAILED;
+
+        sweep_synth_t synth;
+        status_t res = init_sweep_synth(&synth, cfg);
+        if (res != STATUS_OK)
+            return res;
+
+        float *vDst = out.getBuffer(0);
+        size_t nOutLength = out.length();
+
+        // We expect the Sample object to hold more samples than the sweep.
+        if (nOutLength < synth.nLength)
+        {
+            destroy_sweep_synth(&synth);
+            return STATUS_FAILED;
+        }
+
+        // Only the first samples are swept sine, the rest is filled with zeros.
+        size_t nSweep = sweep_synth_process(&synth, vDst, nOutLength);
+        dsp::fill_zero(&vDst[nSweep], nOutLength - nSweep);
+
+        // Clean allocated resources.
+        destroy_sweep_synth(&synth);
+
+        // Done.
+        return STATUS_OK;
+    }
+
+    size_t sweep_period(const config_t *cfg)
+    {
+        return dspu::millis_to_samples(cfg->nSampleRate, 2.0f * cfg->fSweepLength);
+    }
+
+    double exp_sweep_rate(const config_t *cfg)
+    {
+        // Factor of 1000 to convert from milliseconds to seconds.
+        return 0.001 * cfg->fSweepLength / log(double(cfg->fEndFreq) / double(cfg->fStartFreq));
+    }
+
+    size_t harmonic_offset(const config_t *cfg, size_t order)
+    {
+        // The harmonic of order k reaches each frequency L*ln(k) seconds earlier than the fundamental.
+        return size_t(exp_sweep_rate(cfg) * log(double(order)) * cfg->nSampleRate + 0.5);
+    }
+
+    size_t harmonic_predelay(const config_t *cfg)
+    {
+        if (cfg->nHarmonics <= 0)
+            return 0;
+
+        // The half of the distance between the last extracted harmonic and the next one
+        return (harmonic_offset(cfg, cfg->nHarmonics + 1) - harmonic_offset(cfg, cfg->nHarmonics)) / 2;
+    }
+
+    void apply_sweep_envelope(const config_t *cfg, dspu::Sample *dst)
+    {
+        if (cfg->nSweepType != SWEEP_EXP)
+            return;
+
+        // The exponential sweep has the pink spectrum, so the kernel should be weighted by the
+        // instantaneous frequency f(t)/f2 = exp((t - T)/L) to get the flat overall response.
+        // After the end of the sweep the weight stays at 1.
+        double dRate    = exp_sweep_rate(cfg);
+        double dStep    = exp(1.0 / (dRate * cfg->nSampleRate));
+        size_t nSweep   = lsp_min(size_t(dspu::millis_to_samples(cfg->nSampleRate, cfg->fSweepLength)), dst->length());
+
+        for (size_t i=0; i<dst->channels(); ++i)
+        {
+            float *buf      = dst->getBuffer(i);
+            double dGain    = double(cfg->fStartFreq) / double(cfg->fEndFreq);
+            for (size_t n=0; n<nSweep; ++n, dGain *= dStep)
+                buf[n]         *= dGain;
+        }
+    }
+
+    size_t fft_rank(size_t length)
+    {
+        size_t rank = 0;
+        while ((size_t(1) << rank) < length)
+            ++rank;
+        return rank;
+    }
+
+    /**
+     * Input signal of the deconvolution: the sample, the memory-mapped file or the buffers of channels
+     */
+    typedef struct source_t
+    {
+        const dspu::Sample     *pSample;        // Sample, NULL if the mapped file or buffers are used
+        const mapped_wav_t     *pMapped;        // Mapped file, NULL if the sample or buffers are used
+        const float * const    *vBuffers;       // Buffers of channels, used if both sample and mapped file are NULL
+        size_t                  nChannels;      // Number of channels in buffers
+        size_t                  nLength;        // Length of buffers
+    } source_t;
+
+    /**
+     * Deconvolution task shared between all worker threads
+     */
+    typedef struct deconv_task_t
+    {
+        const source_t         *pIn;            // Input signal
+        size_t                  nInChannels;    // Number of input channels
+        size_t                  nInLength;      // Length of the input
+        float * const          *vOut;           // Buffers of output channels
+        size_t                  nOutChannels;   // Number of output channels
+        size_t                  nOutLength;     // Length of output channels
+        const kernel_t * const *vKernels;       // Kernel spectra (read-only)
+        size_t                  nKernels;       // Number of kernels
+        const route_t          *vRoutes;        // Routes, one per each output channel
+        const size_t           *vInputs;        // Input channels used by routes, in ascending order
+        size_t                  nInputs;        // Number of used input channels
+        size_t                  nRadix;         // Radix of the transform
+        size_t                  nRank;          // Rank of the power-of-two part of the transform
+        size_t                  nIRSize;        // Size of the linear convolution result
+        size_t                  nOrigin;        // Origin of time in the deconvolution result
+        size_t                  nZero;          // Position of the zero lag in the deconvolution result
+        size_t                  nLead;          // Number of samples before the origin to keep
+        size_t                  nWindow;        // Length of the window to compute, 0 for the full result
+        size_t                  nFirst;         // Offset of the window after the origin of time
+        size_t                  nShift;         // Offset of the input for the first block of the reference
+        latency_t              *vLatency;       // Latency of each output channel, NULL if not estimated
+        size_t                  nNext;          // Next channel to process
+        ipc::Mutex              sLock;          // Lock to fetch next channel
+        size_t                  nWorkers;       // Number of workers
+        bool                    bPrefetch;      // Pairs of the round are fetched before the transform
+        size_t                  nRound;         // First pair of the round, each worker processes the next one
+        float                 **vFetch;         // Destination buffers of the channels of the round
+        const size_t           *vFetchCh;       // Input channels of the round
+        size_t                  nFetch;         // Number of input channels of the round
+    } deconv_task_t;
+
+    /**
+     * Worker thread state, each worker owns it's scratch buffers
+     */
+    typedef struct deconv_worker_t
+    {
+        deconv_task_t          *pTask;          // Shared task
+        float                  *vRe;            // Working buffer, real part
+        float                  *vIm;            // Working buffer, imaginary part
+        float                  *vSpecRe;        // Spectrum of the pair of input channels, real part
+        float                  *vSpecIm;        // Spectrum of the pair of input channels, imaginary part
+        float                  *vAcc;           // Accumulated spectra for each kernel, partitioned deconvolution only
+        size_t                  nIndex;         // Index of the worker
+        float                 **vFetch;         // Destination buffers of the frames fetched by the worker
+        ipc::Thread            *pThread;        // Thread, NULL for the calling thread
+    } deconv_worker_t;
+
+    size_t select_threads(const config_t *cfg, size_t jobs)
+    {
+        size_t threads  = (cfg->nThreads > 0) ? cfg->nThreads : ipc::Thread::system_cores();
+        return lsp_max(lsp_min(threads, jobs), size_t(1));
+    }
+
+    size_t deconv_rank(size_t in_length, size_t ref_length, size_t *radix)
+    {
+        // The linear convolution result is at most 2 * max(in_length, ref_length) - 1 samples long,
+        // so one transform of at least that size computes it at once without any circular aliasing.
+        // The mixed-radix transform is padded much less than the power-of-two one.
+        return mixed_fft_rank(2 * lsp_max(in_length, ref_length), radix);
+    }
+
+    void init_kernel(kernel_t *k)
+    {
+        k->nRadix       = 1;
+        k->nRank        = 0;
+        k->nLength      = 0;
+        k->vRe          = NULL;
+        k->vIm          = NULL;
+        k->nBlocks      = 0;
+        k->bCalibrated  = false;
+        k->pData        = NULL;
+    }
+
+    status_t build_kernel(kernel_t *k, const dspu::Sample &ref, size_t channel, size_t radix, size_t rank, arena_t *arena)
+    {
+        if (channel >= ref.channels())
+            return STATUS_BAD_ARGUMENTS;
+
+        return build_kernel(k, ref.getBuffer(channel), ref.length(), radix, rank, arena);
+    }
+
+    /**
+     * Take the memory of the kernel spectrum from the arena or allocate it if the arena is NULL
+     * or has not enough free space, the memory taken from the arena is not freed by destroy_kernel()
+     */
+    static float *alloc_kernel(uint8_t * &data, size_t count, arena_t *arena)
+    {
+        data            = NULL;
+        float *ptr      = (arena != NULL) ? arena_alloc<float>(arena, count) : NULL;
+        return (ptr != NULL) ? ptr : alloc_aligned<float>(data, count);
+    }
+
+    status_t build_kernel(kernel_t *k, const float *ref, size_t length, size_t radix, size_t rank, arena_t *arena)
+    {
+        if ((radix != 1) && (radix != 3) && (radix != 5))
+            return STATUS_BAD_ARGUMENTS;
+
+        size_t nFftSize = radix << rank;
+        if (nFftSize < length)
+            return STATUS_BAD_ARGUMENTS;
+
+        uint8_t *pData  = NULL;
+        float *ptr      = alloc_kernel(pData, nFftSize * 2, arena);
+        if (ptr == NULL)
+            return STATUS_NO_MEM;
+
+        destroy_kernel(k);
+
+        k->nRadix       = radix;
+        k->nRank        = rank;
+        k->nLength      = length;
+        k->vRe          = ptr;
+        k->vIm          = &ptr[nFftSize];
+        k->nBlocks      = 1;
+        k->bCalibrated  = false;
+        k->pData        = pData;
+
+        // Let's fill the kernel, it is simply the reference, but backwards in time.
+        dsp::fill_zero(k->vRe, nFftSize);
+        dsp::fill_zero(k->vIm, nFftSize);
+        dsp::reverse2(k->vRe, ref, length);
+        mixed_direct_fft(k->vRe, k->vIm, radix, rank);
+
+        return STATUS_OK;
+    }
+
+    bool ir_window(const config_t *cfg, size_t *first, size_t *length)
+    {
+        if (cfg->fWindowLength <= 0.0f)
+            return false;
+
+        *first      = dspu::millis_to_samples(cfg->nSampleRate, cfg->fWindowStart);
+        *length     = lsp_max(size_t(dspu::millis_to_samples(cfg->nSampleRate, cfg->fWindowLength)), size_t(1));
+        return true;
+    }
+
+    size_t window_rank(size_t length)
+    {
+        // Each block of the reference contributes to the window with the circular correlation of size N,
+        // the block of N - length + 1 samples keeps the first length lags free of circular aliasing.
+        // Too small transforms make too many blocks, so the rank is limited from below.
+        return lsp_max(fft_rank(2 * length), size_t(WINDOW_MIN_RANK));
+    }
+
+    status_t build_window_kernel(kernel_t *k, const dspu::Sample &ref, size_t channel, size_t rank, size_t length, arena_t *arena)
+    {
+        if (channel >= ref.channels())
+            return STATUS_BAD_ARGUMENTS;
+
+        size_t nFftSize = size_t(1) << rank;
+        if ((length <= 0) || (length > nFftSize))
+            return STATUS_BAD_ARGUMENTS;
+
+        // The trailing silence of the reference does not contribute to the result
+        const float *src = ref.getBuffer(channel);
+        size_t nLength  = ref.length();
+        while ((nLength > 0) && (src[nLength - 1] == 0.0f))
+            --nLength;
+
+        size_t nBlock   = nFftSize - length + 1;
+        size_t nBlocks  = lsp_max((nLength + nBlock - 1) / nBlock, size_t(1));
+
+        uint8_t *pData  = NULL;
+        float *ptr      = alloc_kernel(pData, nFftSize * nBlocks * 2, arena);
+        if (ptr == NULL)
+            return STATUS_NO_MEM;
+
+        destroy_kernel(k);
+
+        k->nRadix       = 1;
+        k->nRank        = rank;
+        k->nLength      = ref.length();
+        k->vRe          = ptr;
+        k->vIm          = &ptr[nFftSize * nBlocks];
+        k->nBlocks      = nBlocks;
+        k->bCalibrated  = false;
+        k->pData        = pData;
+
+        // Each block is stored as the complex conjugate of it's spectrum, so the product with the spectrum
+        // of the input gives the correlation with the block instead of the convolution
+        for (size_t i=0; i<nBlocks; ++i)
+        {
+            float *re       = &k->vRe[i * nFftSize];
+            float *im       = &k->vIm[i * nFftSize];
+            size_t first    = i * nBlock;
+            size_t count    = (first < nLength) ? lsp_min(nLength - first, nBlock) : 0;
+
+            dsp::fill_zero(re, nFftSize);
+            dsp::fill_zero(im, nFftSize);
+            dsp::copy(re, &src[first], count);
+            dsp::direct_fft(re, im, re, im, rank);
+            dsp::mul_k2(im, -1.0f, nFftSize);
+        }
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Compute the regularization level (in dB) at the specified frequency: the configured level inside
+     * the band of the sweep, rising to the out-of-band level over the transition band outside of it
+     */
+    static double regularization_level(const config_t *cfg, double freq)
+    {
+        double octaves  = 0.0;
+        if (freq < cfg->fStartFreq)
+            octaves         = (freq > 0.0) ? log2(cfg->fStartFreq / freq) : REG_TRANSITION;
+        else if (freq > cfg->fEndFreq)
+            octaves         = log2(freq / cfg->fEndFreq);
+
+        double w        = (octaves >= REG_TRANSITION) ? 1.0 : 0.5 - 0.5 * cos(M_PI * octaves / REG_TRANSITION);
+        return cfg->fRegLevel + w * (REG_OUT_OF_BAND - cfg->fRegLevel);
+    }
+
+    void regularize_kernel(const config_t *cfg, kernel_t *k)
+    {
+        size_t nFftSize = k->nRadix << k->nRank;
+        size_t nHalf    = nFftSize >> 1;
+        float *vRe      = k->vRe;
+        float *vIm      = k->vIm;
+
+        // The regularization is relative to the peak of the power spectrum of the reference
+        double peak     = 0.0;
+        for (size_t i=0; i<nFftSize; ++i)
+            peak            = lsp_max(peak, double(vRe[i]) * vRe[i] + double(vIm[i]) * vIm[i]);
+        if (peak <= 0.0)
+            return;
+
+        // The kernel is the spectrum of the time-reversed reference, so K / (|K|^2 + eps) is the regularized
+        // inverse of the reference with the same origin of time. The spectrum of the real signal is symmetric,
+        // so the regularization for bins i and N-i is the same. Bins of the mixed-radix spectrum are reordered.
+        double kf       = double(cfg->nSampleRate) / nFftSize;
+        for (size_t n=0; n<=nHalf; ++n)
+        {
+            double eps      = peak * dspu::db_to_power(regularization_level(cfg, n * kf));
+            size_t i        = mixed_fft_bin(n, k->nRadix, k->nRank);
+            size_t j        = mixed_fft_bin((nFftSize - n) % nFftSize, k->nRadix, k->nRank);
+
+            double re       = vRe[i], im = vIm[i];
+            vRe[i]          = re / (re * re + im * im + eps);
+            vIm[i]          = im / (re * re + im * im + eps);
+            if (j == i)
+                continue;
+
+            re              = vRe[j];
+            im              = vIm[j];
+            vRe[j]          = re / (re * re + im * im + eps);
+            vIm[j]          = im / (re * re + im * im + eps);
+        }
+
+        k->bCalibrated  = true;
+    }
+
+    void destroy_kernel(kernel_t *k)
+    {
+        if (k->pData != NULL)
+            free_aligned(k->pData);
+        init_kernel(k);
+    }
+
+    /**
+     * Check that the input channel is selected for deconvolution
+     */
+    static bool is_selected(const config_t *cfg, size_t ch)
+    {
+        size_t n = cfg->vChannels.size();
+        if (n <= 0)
+            return true;
+
+        for (size_t i=0; i < n; ++i)
+            if (*cfg->vChannels.uget(i) == ch)
+                return true;
+
+        return false;
+    }
+
+    status_t build_routes(const config_t *cfg, size_t in_channels, size_t ref_channels, lltl::darray<route_t> *routes)
+    {
+        size_t nmap = cfg->vRefMap.size();
+        routes->flush();
+
+        if ((cfg->bMatrix) && (nmap > 0))
+        {
+            fprintf(stderr, "Reference map can not be used in matrix mode\n");
+            return STATUS_BAD_ARGUMENTS;
+        }
+        if ((nmap > 0) && (nmap != in_channels))
+        {
+            fprintf(stderr, "Reference map should have %d entries, one for each input channel\n", int(in_channels));
+            return STATUS_BAD_ARGUMENTS;
+        }
+        if ((!cfg->bMatrix) && (nmap <= 0) && (ref_channels != 1) && (ref_channels != in_channels))
+        {
+            fprintf(stderr, "Reference with %d channels requires reference map or matrix mode\n", int(ref_channels));
+            return STATUS_BAD_ARGUMENTS;
+        }
+        for (size_t i=0, n=cfg->vChannels.size(); i < n; ++i)
+        {
+            size_t ch = *cfg->vChannels.uget(i);
+            if (ch >= in_channels)
+            {
+                fprintf(stderr, "Selected input channel %d is missing\n", int(ch));
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+
+        // In the matrix mode the output is grouped by sources: all input channels for the first reference
+        // channel, then all input channels for the second one, and so on.
+        size_t nsources = (cfg->bMatrix) ? ref_channels : 1;
+        for (size_t s=0; s < nsources; ++s)
+            for (size_t m=0; m < in_channels; ++m)
+            {
+                if (!is_selected(cfg, m))
+                    continue;
+
+                route_t *r = routes->add();
+                if (r == NULL)
+                    return STATUS_NO_MEM;
+
+                r->nInput   = m;
+                if (cfg->bMatrix)
+                    r->nKernel  = s;
+                else if (nmap > 0)
+                    r->nKernel  = *cfg->vRefMap.uget(m);
+                else
+                    r->nKernel  = (ref_channels == 1) ? 0 : m;
+
+                if (r->nKernel >= ref_channels)
+                {
+                    fprintf(stderr, "Reference map refers to missing reference channel %d\n", int(r->nKernel));
+                    return STATUS_BAD_ARGUMENTS;
+                }
+            }
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Check that any of the pair of input channels is routed to the kernel,
+     * negative kernel index matches any kernel
+     */
+    static inline bool is_routed(const deconv_task_t *t, const size_t *ch, size_t count, ssize_t kernel)
+    {
+        const route_t *r = t->vRoutes;
+        for (size_t i=0, n=t->nOutChannels; i < n; ++i, ++r)
+        {
+            if ((r->nInput != ch[0]) && ((count < 2) || (r->nInput != ch[1])))
+                continue;
+            if ((kernel < 0) || (r->nKernel == size_t(kernel)))
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Read the range of the input channels, the part beyond the end of the input is padded with zeros.
+     * The frames of the mapped input are de-interleaved for all channels in one pass.
+     */
+    static void fetch_range(const deconv_task_t *t, float * const *dst, const size_t *ch, size_t n,
+        size_t first, size_t size)
+    {
+        const source_t *src     = t->pIn;
+        size_t count            = (first < t->nInLength) ? lsp_min(t->nInLength - first, size) : 0;
+        if (count > 0)
+        {
+            if (src->pMapped != NULL)
+                read_mapped_channels(src->pMapped, dst, ch, n, first, count);
+            else if (src->pSample != NULL)
+            {
+                for (size_t i=0; i<n; ++i)
+                    dsp::copy(dst[i], &src->pSample->getBuffer(ch[i])[first], count);
+            }
+            else
+            {
+                for (size_t i=0; i<n; ++i)
+                    dsp::copy(dst[i], &src->vBuffers[ch[i]][first], count);
+            }
+        }
+        for (size_t i=0; i<n; ++i)
+            dsp::fill_zero(&dst[i][count], size - count);
+    }
+
+    /**
+     * Read the range of the pair of input channels into the spectrum buffers of the worker
+     */
+    static void fetch_pair(const deconv_task_t *t, deconv_worker_t *w, const size_t *ch, size_t n,
+        size_t first, size_t size)
+    {
+        float *dst[2]           = { w->vSpecRe, w->vSpecIm };
+        fetch_range(t, dst, ch, n, first, size);
+        if (n < 2)
+            dsp::fill_zero(w->vSpecIm, size);
+    }
+
+    /**
+     * Store the deconvolution result of the channel to the output
+     */
+    static void store_result(deconv_task_t *t, size_t channel, const kernel_t *kernel, float *result)
+    {
+        float *dst              = t->vOut[channel];
+
+        // The regularized inverse filter already gives the response in physical units. Otherwise,
+        // to scale to physical units correctly we should know the nominal bandwidth of the test chirp...
+        // Let's just normalize, gain is just a factor at the end.
+        // Also: response must not contain absolute values higher than 1.
+        if (t->nWindow > 0)
+        {
+            // The window starts at the lag nShift of the correlation
+            if (t->vLatency != NULL)
+            {
+                estimate_latency(&t->vLatency[channel], result, t->nWindow);
+                t->vLatency[channel].fDelay    += t->nShift;
+            }
+            if (!kernel->bCalibrated)
+                dsp::normalize(result, result, t->nWindow);
+            dsp::fill_zero(dst, t->nOutLength);
+            dsp::copy(dst, result, lsp_min(t->nOutLength, t->nWindow));
+            return;
+        }
+
+        // The latency is searched at non-negative lags up to the length of the input. The origin of time
+        // is at the zero lag only when the input is not longer than the reference, so the search starts
+        // at the zero lag itself
+        if (t->vLatency != NULL)
+            estimate_latency(&t->vLatency[channel], &result[t->nZero], lsp_max(t->nInLength, size_t(1)));
+        if (!kernel->bCalibrated)
+            dsp::normalize(result, result, t->nIRSize);
+        dsp::fill_zero(dst, t->nOutLength);
+        size_t first = t->nOrigin - t->nLead;
+        dsp::copy(dst, &result[first], lsp_min(t->nOutLength, t->nIRSize - first));
+    }
+
+    static void deconvolve_pair(deconv_task_t *t, deconv_worker_t *w, size_t pair)
+    {
+        size_t nFftSize         = t->nRadix << t->nRank;
+        const size_t *ch        = &t->vInputs[pair * 2];
+        size_t nPair            = lsp_min(t->nInputs - pair * 2, size_t(2));
+
+        // The kernel is real, so two real channels can be passed through one complex transform:
+        // the first one as the real part and the second one as the imaginary part. After the inverse
+        // transform the real and imaginary parts hold the deconvolution results of each channel.
+        // The direct transform of the pair is computed once for all kernels.
+        // The memory-mapped input is converted directly into the transform buffers.
+        if (!t->bPrefetch)
+            fetch_pair(t, w, ch, nPair, 0, nFftSize);
+        else if (nPair < 2)
+            dsp::fill_zero(w->vSpecIm, nFftSize);
+        mixed_direct_fft(w->vSpecRe, w->vSpecIm, t->nRadix, t->nRank);
+
+        for (size_t k=0; k < t->nKernels; ++k)
+        {
+            if (!is_routed(t, ch, nPair, k))
+                continue;
+
+            const kernel_t *kernel  = t->vKernels[k];
+            dsp::complex_mul3(w->vRe, w->vIm, w->vSpecRe, w->vSpecIm, kernel->vRe, kernel->vIm, nFftSize);
+            mixed_reverse_fft(w->vRe, w->vIm, t->nRadix, t->nRank);
+
+            const route_t *r        = t->vRoutes;
+            for (size_t i=0, n=t->nOutChannels; i < n; ++i, ++r)
+            {
+                if (r->nKernel != k)
+                    continue;
+                if (r->nInput == ch[0])
+                    store_result(t, i, kernel, w->vRe);
+                else if ((nPair > 1) && (r->nInput == ch[1]))
+                    store_result(t, i, kernel, w->vIm);
+            }
+        }
+    }
+
+    static void deconvolve_pair_window(deconv_task_t *t, deconv_worker_t *w, size_t pair)
+    {
+        size_t nFftSize         = size_t(1) << t->nRank;
+        size_t nBlock           = nFftSize - t->nWindow + 1;
+        size_t nBlocks          = t->vKernels[t->vRoutes[0].nKernel]->nBlocks;
+        const size_t *ch        = &t->vInputs[pair * 2];
+        size_t nPair            = lsp_min(t->nInputs - pair * 2, size_t(2));
+
+        for (size_t k=0; k < t->nKernels; ++k)
+        {
+            if (is_routed(t, ch, nPair, k))
+                dsp::fill_zero(&w->vAcc[k * nFftSize * 2], nFftSize * 2);
+        }
+
+        // Each block of the reference is correlated with the segment of the input which starts at the same
+        // position shifted by the start of the window. The segment is nFftSize samples long, so the first
+        // nWindow lags of the circular correlation are not aliased. The spectra of all blocks are summed
+        // and only one inverse transform per kernel gives the window. Two input channels are packed into
+        // one complex transform as for the full deconvolution.
+        for (size_t b=0; b < nBlocks; ++b)
+        {
+            size_t first            = b * nBlock + t->nShift;
+            if (first >= t->nInLength)
+                break;
+
+            fetch_pair(t, w, ch, nPair, first, nFftSize);
+            dsp::direct_fft(w->vSpecRe, w->vSpecIm, w->vSpecRe, w->vSpecIm, t->nRank);
+
+            for (size_t k=0; k < t->nKernels; ++k)
+            {
+                if (!is_routed(t, ch, nPair, k))
+                    continue;
+
+                const kernel_t *kernel  = t->vKernels[k];
+                float *acc              = &w->vAcc[k * nFftSize * 2];
+                dsp::complex_mul3(w->vRe, w->vIm, w->vSpecRe, w->vSpecIm,
+                    &kernel->vRe[b * nFftSize], &kernel->vIm[b * nFftSize], nFftSize);
+                dsp::add2(acc, w->vRe, nFftSize);
+                dsp::add2(&acc[nFftSize], w->vIm, nFftSize);
+            }
+        }
+
+        for (size_t k=0; k < t->nKernels; ++k)
+        {
+            if (!is_routed(t, ch, nPair, k))
+                continue;
+
+            const kernel_t *kernel  = t->vKernels[k];
+            float *re               = &w->vAcc[k * nFftSize * 2];
+            float *im               = &re[nFftSize];
+            dsp::reverse_fft(re, im, re, im, t->nRank);
+
+            const route_t *r        = t->vRoutes;
+            for (size_t i=0, n=t->nOutChannels; i < n; ++i, ++r)
+            {
+                if (r->nKernel != k)
+                    continue;
+                if (r->nInput == ch[0])
+                    store_result(t, i, kernel, re);
+                else if ((nPair > 1) && (r->nInput == ch[1]))
+                    store_result(t, i, kernel, im);
+            }
+        }
+    }
+
+    void estimate_latency(latency_t *dst, const float *src, size_t count)
+    {
+        size_t peak     = dsp::abs_max_index(src, count);
+        float delta     = 0.0f;
+
+        // Fit the parabola to the magnitudes around the peak to get the fractional delay
+        if ((peak > 0) && (peak + 1 < count))
+        {
+            float a         = fabsf(src[peak - 1]);
+            float b         = fabsf(src[peak]);
+            float c         = fabsf(src[peak + 1]);
+            float d         = a - 2.0f * b + c;
+            if (d < 0.0f)
+                delta           = 0.5f * (a - c) / d;
+        }
+
+        dst->fDelay     = peak + delta;
+        dst->fPeak      = src[peak];
+    }
+
+    static status_t deconvolve_worker(void *arg)
+    {
+        deconv_worker_t *w  = static_cast<deconv_worker_t *>(arg);
+        deconv_task_t *t    = w->pTask;
+
+        // Each additional thread should initialize DSP context
+        dsp::context_t ctx;
+        if (w->pThread != NULL)
+            dsp::start(&ctx);
+
+        if (t->bPrefetch)
+        {
+            // The pair of the round is already in the buffers of the worker
+            size_t pair = t->nRound + w->nIndex;
+            if (pair * 2 < t->nInputs)
+                deconvolve_pair(t, w, pair);
+        }
+        else
+        {
+            while (true)
+            {
+                // Fetch the next pair of channels
+                t->sLock.lock();
+                size_t pair = t->nNext++;
+                t->sLock.unlock();
+
+                if (pair * 2 >= t->nInputs)
+                    break;
+
+                if (t->nWindow > 0)
+                    deconvolve_pair_window(t, w, pair);
+                else
+                    deconvolve_pair(t, w, pair);
+            }
+        }
+
+        if (w->pThread != NULL)
+            dsp::finish(&ctx);
+
+        return STATUS_OK;
+    }
 
-        size_t nOversampling = sOversampler.get_oversampling();
-        size_t nOverRate = nOversampling * cfg->nSampleRate;
+    /**
+     * Fetch the part of frames of all channels of the round, the workers split the frames between them
+     */
+    static status_t fetch_worker(void *arg)
+    {
+        deconv_worker_t *w  = static_cast<deconv_worker_t *>(arg);
+        deconv_task_t *t    = w->pTask;
 
-        // Allocate the array of the oversampled chirp samples.
-        uint8_t *pData;
-        size_t nSamples = dspu::millis_to_samples(nOverRate, cfg->fSweepLength);
+        dsp::context_t ctx;
+        if (w->pThread != NULL)
+            dsp::start(&ctx);
 
-        float *ptr = alloc_aligned<float>(pData, nSamples);
-        if (ptr == NULL)
-            return STATUS_NO_MEM;
+        size_t nFftSize     = t->nRadix << t->nRank;
+        size_t step         = (nFftSize + t->nWorkers - 1) / t->nWorkers;
+        size_t first        = lsp_min(w->nIndex * step, nFftSize);
+        size_t size         = lsp_min(nFftSize - first, step);
+        for (size_t i=0; i < t->nFetch; ++i)
+            w->vFetch[i]        = &t->vFetch[i][first];
+        fetch_range(t, w->vFetch, t->vFetchCh, t->nFetch, first, size);
 
-        lsp_guard_assert(float *save = ptr);
+        if (w->pThread != NULL)
+            dsp::finish(&ctx);
 
-        float *vSweep = ptr;
-        ptr += nSamples;
+        return STATUS_OK;
+    }
 
-        lsp_assert(ptr <= &save[nSamples]);
+    static size_t source_channels(const source_t *in)
+    {
+        if (in->pMapped != NULL)
+            return in->pMapped->nChannels;
+        return (in->pSample != NULL) ? in->pSample->channels() : in->nChannels;
+    }
 
-        // Some synth action. Linear Swept Sine (it makes deconvolution easier, lowers aliasing).
-        // Factor of 1000 to convert from milliseconds to seconds.
-        float fSlope = 1000.0f * (cfg->fEndFreq - cfg->fStartFreq) / cfg->fSweepLength;
+    static size_t source_length(const source_t *in)
+    {
+        if (in->pMapped != NULL)
+            return size_t(in->pMapped->nFrames);
+        return (in->pSample != NULL) ? in->pSample->length() : in->nLength;
+    }
 
-        // Below we compute samples using double precision and phase wrapping. This highly reduces aliasing.
-        for (size_t n = 0; n < nSamples; ++n)
+    /**
+     * Process the task with the specified number of workers, the calling thread works as the first worker
+     */
+    static void run_workers(deconv_worker_t *workers, size_t count, ipc::thread_proc_t proc)
+    {
+        for (size_t i = 1; i < count; ++i)
         {
-            // Use double for maximal accuracy, convert to float on assignment.
-            double dTime = double(n) / nOverRate;
-            // For linear chirp we use quadratic instantaneous phase.
-            double dPhase = 2.0 * M_PI * (0.5 * fSlope * dTime * dTime + cfg->fStartFreq * dTime);
-            // Wrap phase between -M_PI and M_PI to maximise sin accuracy.
-            dPhase = fmod(dPhase + M_PI, 2.0 * M_PI);
-            dPhase = dPhase >= 0.0 ? (dPhase - M_PI) : (dPhase + M_PI);
-            // Ready
-            vSweep[n] = sin(dPhase);
+            deconv_worker_t *w  = &workers[i];
+            w->pThread  = new (std::nothrow) ipc::Thread(proc, w);
+            if (w->pThread == NULL)
+                break;
+            if (w->pThread->start() != STATUS_OK)
+            {
+                delete w->pThread;
+                w->pThread  = NULL;
+                break;
+            }
         }
 
-        // Scale with gain, but the maximum gain must be 1 to prevent clipping in the final file.
-        dsp::mul_k2(vSweep, lsp_min(dspu::db_to_gain(cfg->fGain), 1.0f), nSamples);
-
-        // In-place downsample.
-        size_t nDownSamples = nSamples / nOversampling;
-        sOversampler.downsample(vSweep, vSweep, nDownSamples);
-
-        // Copy to destination Sample object.
-
-        // We expect this to be mono.
-        if (out.channels() != 1)
-            return STATUS_FAILED;
-
-        float *vDst = out.getBuffer(0);
-        size_t nOutLength = out.length();
+        // If some threads have failed to start, their work is done by the calling thread
+        proc(&workers[0]);
+        for (size_t i = 1; i < count; ++i)
+        {
+            if (workers[i].pThread == NULL)
+                proc(&workers[i]);
+        }
 
-        // We expect the Sample object to hold more samples than the sweep.
-        if (nOutLength < nDownSamples)
-            return STATUS_FAILED;
+        for (size_t i = 1; i < count; ++i)
+        {
+            deconv_worker_t *w  = &workers[i];
+            if (w->pThread == NULL)
+                continue;
+            w->pThread->join();
+            delete w->pThread;
+            w->pThread  = NULL;
+        }
+    }
 
-        // Fill with zero first, only the first samples are swept sine.
-        dsp::fill_zero(vDst, nOutLength);
+    /**
+     * Compute the size of scratch buffers of each worker:
+     * 2X Working buffer (real and imaginary parts), of size nFftSize
+     * 2X Spectrum of the input pair, of size nFftSize, if there are several kernels or the kernels
+     *    are partitioned, with the only kernel the spectrum is transformed in place
+     * 2X Accumulated spectrum, of size nFftSize, per each kernel for the partitioned deconvolution
+     */
+    static size_t worker_scratch_size(size_t fft_size, size_t nkernels, bool partitioned)
+    {
+        size_t size     = ((nkernels > 1) || (partitioned)) ? fft_size * 4 : fft_size * 2;
+        if (partitioned)
+            size           += fft_size * 2 * nkernels;
+        return size;
+    }
 
-        // Copy The swept sine.
-        dsp::copy(vDst, vSweep, nDownSamples);
+    /**
+     * Compute the number of workers for the input channels, each worker processes a pair of them
+     * with it's own scratch buffers. If the number of threads is not specified, the scratch of all
+     * workers should fit into the half of the available physical memory, the rest is left for the
+     * input, the output and the kernels.
+     */
+    static size_t deconv_threads(const config_t *cfg, size_t channels, size_t fft_size, size_t nkernels, bool partitioned)
+    {
+        size_t threads  = select_threads(cfg, (channels + 1) >> 1);
+        if (cfg->nThreads > 0)
+            return threads;
 
-        // Clean allocated resources.
-        sOversampler.destroy();
+        wsize_t avail   = available_memory() / 2;
+        wsize_t scratch = arena_size<float>(worker_scratch_size(fft_size, nkernels, partitioned));
+        if ((avail <= 0) || (scratch <= 0))
+            return threads;
 
-        free_aligned(pData);
-        pData = NULL;
-        vSweep = NULL;
+        return size_t(lsp_max(lsp_min(wsize_t(threads), avail / scratch), wsize_t(1)));
+    }
 
-        // Done.
-        return STATUS_OK;
+    size_t deconv_arena_size(size_t radix, size_t rank, size_t nkernels, size_t threads)
+    {
+        return arena_size<float>(worker_scratch_size(radix << rank, nkernels, false) * lsp_max(threads, size_t(1)));
     }
 
-    status_t deconvolve(const config_t *cfg, const dspu::Sample &in, const dspu::Sample &ref, dspu::Sample &out)
+    /**
+     * Deconvolve the input signal. If the window is not empty, the kernels should be partitioned
+     * and only the window of the result is computed, otherwise the full result is computed.
+     * If the arena is not specified or has not enough free space, the memory is allocated for the call.
+     */
+    static status_t deconvolve_source(const source_t *in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, float * const *out, size_t out_channels, size_t out_length, size_t threads,
+        size_t lead, size_t first, size_t window, latency_t *latency, arena_t *arena)
     {
+        size_t nRoutes = out_channels;
+        size_t nInChannels = source_channels(in);
+        size_t nInLength = source_length(in);
+        if ((nRoutes <= 0) || (nkernels <= 0))
+            return STATUS_BAD_ARGUMENTS;
+
+        // All kernels used by routes should be computed for the same reference length and
+        // for the transform of proper size
+        const kernel_t *kernel = kernels[routes[0].nKernel];
+        for (size_t i=0; i < nRoutes; ++i)
+        {
+            if ((routes[i].nInput >= nInChannels) || (routes[i].nKernel >= nkernels))
+                return STATUS_BAD_ARGUMENTS;
+            const kernel_t *k = kernels[routes[i].nKernel];
+            if ((k->nRadix != kernel->nRadix) || (k->nRank != kernel->nRank) ||
+                (k->nLength != kernel->nLength) || (k->nBlocks != kernel->nBlocks))
+                return STATUS_BAD_ARGUMENTS;
+        }
+
         // We first prepare the data in a new buffers as we need to have them all the same length.
-        size_t nBufferSize = lsp_max(in.length(), ref.length());
+        size_t nBufferSize = lsp_max(nInLength, kernel->nLength);
         // This is the convolution size for one buffer nBufferSize long and one nBufferSize + 1 long.
         // We can think of the input being nBufferSize + 1 long by padding it. We will actually pad it to the full
         // convolution size so that we can do the convolution in one go. This will make the convolution size even,
         // which gives the best results for latency removal.
         size_t nIRSize = 2 * nBufferSize;
         size_t nOrigin = nBufferSize - 1; // this is the origin of time in the deconvolution result.
-        size_t nInChannels = in.channels();
 
-        // We expect the reference to be mono.
-        if (ref.channels() != 1)
-            return STATUS_FAILED;
+        // The kernel should be computed for the transform of proper size, the full transform
+        // may be larger than required: the tail of the result is just filled with zeros
+        size_t radix = 1;
+        size_t rank = (window > 0) ? window_rank(window) : deconv_rank(nInLength, kernel->nLength, &radix);
+        size_t nFftSize = kernel->nRadix << kernel->nRank;
+        if ((window > 0) ? ((kernel->nRadix != 1) || (kernel->nRank != rank)) : (nFftSize < (radix << rank)))
+            return STATUS_BAD_ARGUMENTS;
+
+        // The negative time part is limited by the length of the result
+        if (lead > nOrigin)
+            return STATUS_BAD_ARGUMENTS;
 
-        // We will process the input channels one at a time.
-        // Allocate 3 buffers:
-        // 1X Input data buffer, of size nIRSize, so that the convolution operation produces the correct number of samples.
-        // 1X Deconvolution kernel buffer, of size nBufferSize
-        // 1X Deconvolution result buffer, of size nIRSize
-        uint8_t *pData;
-        size_t nTotal = nIRSize + nBufferSize + nIRSize;
+        // Only input channels used by routes are transformed, they are processed by pairs
+        size_t *vInputs = new (std::nothrow) size_t[nInChannels];
+        if (vInputs == NULL)
+            return STATUS_NO_MEM;
+        size_t nInputs = 0;
+        for (size_t ch=0; ch < nInChannels; ++ch)
+        {
+            for (size_t i=0; i < nRoutes; ++i)
+                if (routes[i].nInput == ch)
+                {
+                    vInputs[nInputs++] = ch;
+                    break;
+                }
+        }
+
+        // Each worker processes it's own pair at a time
+        size_t nWorkers = lsp_max(lsp_min(threads, (nInputs + 1) >> 1), size_t(1));
 
-        float *ptr = alloc_aligned<float>(pData, nTotal);
+        // Take buffers from the arena, the caller keeps the arena between calls
+        arena_t local;
+        init_arena(&local, false);
+        size_t nTotal = worker_scratch_size(nFftSize, nkernels, window > 0) * nWorkers;
+        size_t nMark = (arena != NULL) ? arena->nUsed : 0;
+        float *ptr = (arena != NULL) ? arena_alloc<float>(arena, nTotal) : NULL;
         if (ptr == NULL)
+        {
+            if (reserve_arena(&local, arena_size<float>(nTotal)) != STATUS_OK)
+            {
+                delete [] vInputs;
+                return STATUS_NO_MEM;
+            }
+            ptr = arena_alloc<float>(&local, nTotal);
+        }
+
+        // The mapped input is de-interleaved for all pairs of the round at once, each worker keeps
+        // the destination buffers of it's part of frames
+        size_t nPairs = (nInputs + 1) >> 1;
+        bool bPrefetch = (in->pMapped != NULL) && (window <= 0) && (nPairs > 1);
+        deconv_worker_t *vWorkers = new (std::nothrow) deconv_worker_t[nWorkers];
+        float **vFetch = (bPrefetch) ? new (std::nothrow) float *[nWorkers * 2 * (nWorkers + 1)] : NULL;
+        if ((vWorkers == NULL) || ((bPrefetch) && (vFetch == NULL)))
+        {
+            if (arena != NULL)
+                rewind_arena(arena, nMark);
+            destroy_arena(&local);
+            delete [] vFetch;
+            delete [] vWorkers;
+            delete [] vInputs;
             return STATUS_NO_MEM;
+        }
 
         lsp_guard_assert(float *save = ptr);
 
-        float *vInput = ptr;
-        ptr += nIRSize;
+        deconv_task_t task;
+        task.pIn        = in;
+        task.nInChannels= nInChannels;
+        task.nInLength  = nInLength;
+        task.vOut       = out;
+        task.nOutChannels= out_channels;
+        task.nOutLength = out_length;
+        task.vKernels   = kernels;
+        task.nKernels   = nkernels;
+        task.vRoutes    = routes;
+        task.vInputs    = vInputs;
+        task.nInputs    = nInputs;
+        task.nRadix     = kernel->nRadix;
+        task.nRank      = kernel->nRank;
+        task.nIRSize    = nIRSize;
+        task.nOrigin    = nOrigin;
+        task.nZero      = nOrigin - (nBufferSize - kernel->nLength);
+        task.nLead      = lead;
+        task.nWindow    = window;
+        task.nFirst     = first;
+        // The sample nOrigin + first of the result is the correlation at lag first + nBufferSize - kernel->nLength
+        task.nShift     = first + nBufferSize - kernel->nLength;
+        task.vLatency   = latency;
+        task.nNext      = 0;
+        task.nWorkers   = nWorkers;
+        task.bPrefetch  = bPrefetch;
+        task.nRound     = 0;
+        task.vFetch     = vFetch;
+        task.vFetchCh   = vInputs;
+        task.nFetch     = 0;
 
-        float *vKernel = ptr;
-        ptr += nBufferSize;
-
-        float *vResult = ptr;
-        ptr += nIRSize;
+        for (size_t i = 0; i < nWorkers; ++i)
+        {
+            deconv_worker_t *w  = &vWorkers[i];
+            w->pTask    = &task;
+            w->vRe      = ptr;
+            ptr        += nFftSize;
+            w->vIm      = ptr;
+            ptr        += nFftSize;
+            if ((nkernels > 1) || (window > 0))
+            {
+                w->vSpecRe  = ptr;
+                ptr        += nFftSize;
+                w->vSpecIm  = ptr;
+                ptr        += nFftSize;
+            }
+            else
+            {
+                w->vSpecRe  = w->vRe;
+                w->vSpecIm  = w->vIm;
+            }
+            w->vAcc     = NULL;
+            if (window > 0)
+            {
+                w->vAcc     = ptr;
+                ptr        += nFftSize * 2 * nkernels;
+            }
+            w->nIndex   = i;
+            w->vFetch   = (bPrefetch) ? &vFetch[nWorkers * 2 * (i + 1)] : NULL;
+            w->pThread  = NULL;
+        }
 
         lsp_assert(ptr <= &save[nTotal]);
 
-        // Let's fill the kernel, it is simply the reference, but backwards in time.
-        dsp::fill_zero(vKernel, nBufferSize);
-        const float *vRef = ref.getBuffer(0);
-        dsp::reverse2(vKernel, vRef, ref.length());
+        // Process
+        if (bPrefetch)
+        {
+            // Each pass over the mapped input fetches the frames of all channels of the round into
+            // the buffers of workers, then each worker transforms it's own pair
+            for (size_t pair = 0; pair < nPairs; pair += nWorkers)
+            {
+                size_t count    = lsp_min(nPairs - pair, nWorkers);
+                task.nRound     = pair;
+                task.vFetchCh   = &vInputs[pair * 2];
+                task.nFetch     = lsp_min(nInputs - pair * 2, count * 2);
+                for (size_t i = 0; i < task.nFetch; ++i)
+                    vFetch[i]       = (i & 1) ? vWorkers[i >> 1].vSpecIm : vWorkers[i >> 1].vSpecRe;
+
+                run_workers(vWorkers, nWorkers, fetch_worker);
+                run_workers(vWorkers, count, deconvolve_worker);
+            }
+        }
+        else
+            run_workers(vWorkers, nWorkers, deconvolve_worker);
+
+        // Clean allocated resources.
+        delete [] vFetch;
+        delete [] vWorkers;
+        delete [] vInputs;
+        if (arena != NULL)
+            rewind_arena(arena, nMark);
+        destroy_arena(&local);
+
+        // Done.
+        return STATUS_OK;
+    }
+
+    /**
+     * Deconvolve the source into the buffers of the output sample
+     */
+    static status_t deconvolve_source(const source_t *in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t lead, size_t first, size_t window,
+        latency_t *latency, arena_t *arena)
+    {
+        size_t channels = out.channels();
+        float **vOut    = new (std::nothrow) float *[lsp_max(channels, size_t(1))];
+        if (vOut == NULL)
+            return STATUS_NO_MEM;
+        for (size_t i=0; i < channels; ++i)
+            vOut[i]         = out.getBuffer(i);
+
+        status_t res    = deconvolve_source(in, kernels, nkernels, routes, vOut, channels, out.length(), threads,
+            lead, first, window, latency, arena);
+        delete [] vOut;
+
+        return res;
+    }
+
+    status_t deconvolve(const dspu::Sample &in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t lead)
+    {
+        source_t src;
+        src.pSample     = &in;
+        src.pMapped     = NULL;
+        src.vBuffers    = NULL;
+
+        return deconvolve_source(&src, kernels, nkernels, routes, out, threads, lead, 0, 0, NULL, NULL);
+    }
+
+    status_t deconvolve(const dspu::Sample &in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t lead, arena_t *arena)
+    {
+        source_t src;
+        src.pSample     = &in;
+        src.pMapped     = NULL;
+        src.vBuffers    = NULL;
+
+        return deconvolve_source(&src, kernels, nkernels, routes, out, threads, lead, 0, 0, NULL, arena);
+    }
+
+    status_t deconvolve(const float * const *in, size_t in_channels, size_t in_length,
+        const kernel_t * const *kernels, size_t nkernels, const route_t *routes,
+        float * const *out, size_t out_channels, size_t out_length, size_t threads, size_t lead, arena_t *arena)
+    {
+        source_t src;
+        src.pSample     = NULL;
+        src.pMapped     = NULL;
+        src.vBuffers    = in;
+        src.nChannels   = in_channels;
+        src.nLength     = in_length;
+
+        return deconvolve_source(&src, kernels, nkernels, routes, out, out_channels, out_length, threads,
+            lead, 0, 0, NULL, arena);
+    }
+
+    status_t deconvolve_window(const dspu::Sample &in, const kernel_t * const *kernels, size_t nkernels,
+        const route_t *routes, dspu::Sample &out, size_t threads, size_t first, size_t length)
+    {
+        if (length <= 0)
+            return STATUS_BAD_ARGUMENTS;
+
+        source_t src;
+        src.pSample     = &in;
+        src.pMapped     = NULL;
+        src.vBuffers    = NULL;
+
+        return deconvolve_source(&src, kernels, nkernels, routes, out, threads, 0, first, length, NULL, NULL);
+    }
+
+    status_t deconvolve(const dspu::Sample &in, const kernel_t *kernel, dspu::Sample &out, size_t threads, size_t lead,
+        arena_t *arena)
+    {
+        // Each input channel is deconvolved into the same output channel
+        size_t nchannels = in.channels();
+        if (out.channels() != nchannels)
+            return STATUS_BAD_ARGUMENTS;
+
+        route_t *routes = new (std::nothrow) route_t[nchannels];
+        if (routes == NULL)
+            return STATUS_NO_MEM;
+        for (size_t i=0; i < nchannels; ++i)
+        {
+            routes[i].nInput    = i;
+            routes[i].nKernel   = 0;
+        }
+
+        status_t res = deconvolve(in, &kernel, 1, routes, out, threads, lead, arena);
+        delete [] routes;
+
+        return res;
+    }
+
+    void init_kernel_store(kernel_store_t *s)
+    {
+        s->nClock       = 0;
+    }
+
+    void destroy_kernel_store(kernel_store_t *s)
+    {
+        for (size_t i=0, n=s->vItems.size(); i<n; ++i)
+        {
+            stored_kernel_t *item = s->vItems.uget(i);
+            if (item == NULL)
+                continue;
+            destroy_kernel(&item->sKernel);
+            delete item;
+        }
+        s->vItems.flush();
+    }
 
-        // Process.
-        dspu::Convolver sConvolver;
+    /**
+     * Compute the kernel for the reference channel according to the configuration
+     */
+    static status_t prepare_kernel(const config_t *cfg, kernel_t *k, const dspu::Sample &ref, size_t channel,
+        size_t radix, size_t rank, size_t window, arena_t *arena)
+    {
+        status_t res = (window > 0) ?
+            build_window_kernel(k, ref, channel, rank, window, arena) :
+            build_kernel(k, ref, channel, radix, rank, arena);
+        if ((res == STATUS_OK) && (cfg->bRegularize))
+            regularize_kernel(cfg, k);
+        return res;
+    }
 
-        for (size_t ch = 0; ch < nInChannels; ++ch)
+    /**
+     * Destroy the least recently used kernels of the channel which are not in use while their
+     * number exceeds the limit. Should be called with the lock held
+     */
+    static void evict_kernels(kernel_store_t *store, size_t channel)
+    {
+        while (true)
         {
-            // Even though we always use the same impulse response,
-            // we initialise at every iteration to make sure the internal state of the convolver is re-initialisated.
-            if (!sConvolver.init(vKernel, nBufferSize, 16, 0))
+            stored_kernel_t *lru    = NULL;
+            size_t unused           = 0;
+            for (size_t i=0, n=store->vItems.size(); i<n; ++i)
             {
-                free_aligned(pData);
-                return STATUS_NO_MEM;
+                stored_kernel_t *item   = store->vItems.uget(i);
+                if ((item->nChannel != channel) || (item->nRefs > 0))
+                    continue;
+                ++unused;
+                if ((lru == NULL) || (item->nLastUse < lru->nLastUse))
+                    lru                     = item;
             }
 
-            dsp::fill_zero(vInput, nIRSize);
-            dsp::copy(vInput, in.getBuffer(ch), in.length());
-            dsp::fill_zero(vResult, nIRSize);
+            if (unused <= STORED_KERNELS)
+                break;
+
+            store->vItems.premove(lru);
+            destroy_kernel(&lru->sKernel);
+            delete lru;
+        }
+    }
+
+    status_t acquire_kernel(const config_t *cfg, kernel_store_t *store, const dspu::Sample &ref, size_t channel,
+        size_t radix, size_t rank, size_t window, stored_kernel_t **dst)
+    {
+        status_t res;
+
+        // Lookup for the kernel, failed kernels are never matched
+        store->sLock.lock();
+        for (size_t i=0, n=store->vItems.size(); i<n; ++i)
+        {
+            stored_kernel_t *item = store->vItems.uget(i);
+            if ((item->nChannel != channel) || (item->nWindow != window) ||
+                (item->nRadix != radix) || (item->nRank != rank) ||
+                (item->nLength != ref.length()) || (item->nStatus != STATUS_OK))
+                continue;
+
+            ++item->nRefs;
+            item->nLastUse  = ++store->nClock;
+            store->sLock.unlock();
 
-            sConvolver.process(vResult, vInput, nIRSize);
+            // Wait until the kernel is computed by the deconvolution which has put it into the storage
+            item->sLoading.lock();
+            res             = item->nStatus;
+            item->sLoading.unlock();
+            if (res != STATUS_OK)
+            {
+                release_kernel(store, item);
+                return res;
+            }
 
-            // Copy to destination:
-            // To scale to physical units correctly we should know the nominal bandwidth of the test chirp...
-            // Let's just normalize, gain is just a factor at the end.
-            // Also: response must not contain absolute values higher than 1.
-            dsp::normalize(vResult, vResult, nIRSize);
-            dsp::fill_zero(out.getBuffer(ch), out.length());
-            dsp::copy(out.getBuffer(ch), &vResult[nOrigin], lsp_min(out.length(), nIRSize - nOrigin));
+            *dst            = item;
+            return STATUS_OK;
         }
 
-        // Clean allocated resources.
-        free_aligned(pData);
-        pData = NULL;
-        vInput = NULL;
-        vKernel = NULL;
+        // Put the new kernel which is held locked until it is computed
+        stored_kernel_t *item = new (std::nothrow) stored_kernel_t;
+        if ((item == NULL) || (!store->vItems.add(item)))
+        {
+            store->sLock.unlock();
+            if (item != NULL)
+                delete item;
+            return STATUS_NO_MEM;
+        }
 
-        sConvolver.destroy();
+        item->nChannel  = channel;
+        item->nWindow   = window;
+        item->nRadix    = radix;
+        item->nRank     = rank;
+        item->nLength   = ref.length();
+        item->nStatus   = STATUS_OK;
+        item->nRefs     = 1;
+        item->nLastUse  = ++store->nClock;
+        init_kernel(&item->sKernel);
+        item->sLoading.lock();
+        store->sLock.unlock();
 
-        // Done.
+        // Compute the kernel without holding the lock, so other deconvolutions are not blocked
+        res             = prepare_kernel(cfg, &item->sKernel, ref, channel, radix, rank, window, NULL);
+        store->sLock.lock();
+        item->nStatus   = res;
+        store->sLock.unlock();
+        item->sLoading.unlock();
+        if (res != STATUS_OK)
+        {
+            release_kernel(store, item);
+            return res;
+        }
+
+        *dst            = item;
         return STATUS_OK;
     }
 
-    status_t normalize(dspu::Sample *dst, float gain, size_t mode)
+    void release_kernel(kernel_store_t *store, stored_kernel_t *item)
     {
-        if (mode == NORM_NONE)
+        store->sLock.lock();
+        item->nLastUse  = ++store->nClock;
+        if (((--item->nRefs) == 0) && (item->nStatus != STATUS_OK))
+        {
+            store->vItems.premove(item);
+            destroy_kernel(&item->sKernel);
+            delete item;
+        }
+        else
+            evict_kernels(store, item->nChannel);
+        store->sLock.unlock();
+    }
+
+    static status_t deconvolve_source(const config_t *cfg, const source_t *in, const dspu::Sample &ref, dspu::Sample &out,
+        size_t lead, latency_t *latency, kernel_store_t *store, arena_t *arena)
+    {
+        size_t nInChannels  = source_channels(in);
+        size_t nInLength    = source_length(in);
+
+        lltl::darray<route_t> routes;
+        status_t res = build_routes(cfg, nInChannels, ref.channels(), &routes);
+        if (res != STATUS_OK)
+            return res;
+        if (routes.size() != out.channels())
+            return STATUS_BAD_ARGUMENTS;
+
+        // The spectrum of each kernel is computed only once and then shared between all workers
+        // and all input channels routed to it. Reference channels without routes are not transformed.
+        // Kernels taken from the storage are not computed at all.
+        size_t nkernels     = ref.channels();
+        kernel_t *vKernels  = new (std::nothrow) kernel_t[nkernels];
+        if (vKernels == NULL)
+            return STATUS_NO_MEM;
+        const kernel_t **vList = new (std::nothrow) const kernel_t *[nkernels];
+        if (vList == NULL)
+        {
+            delete [] vKernels;
+            return STATUS_NO_MEM;
+        }
+        stored_kernel_t **vStored = new (std::nothrow) stored_kernel_t *[nkernels];
+        if (vStored == NULL)
+        {
+            delete [] vList;
+            delete [] vKernels;
+            return STATUS_NO_MEM;
+        }
+
+        for (size_t i=0; i < nkernels; ++i)
+        {
+            init_kernel(&vKernels[i]);
+            vList[i]    = NULL;
+            vStored[i]  = NULL;
+        }
+
+        // Only the window of the result can be computed with partitioned kernels of much smaller rank
+        size_t first = 0, window = 0;
+        bool partitioned    = ir_window(cfg, &first, &window);
+        size_t radix        = 1;
+        size_t rank         = (partitioned) ? window_rank(window) : deconv_rank(nInLength, ref.length(), &radix);
+        if ((partitioned) && (cfg->bRegularize))
+        {
+            fprintf(stderr, "Regularized inverse filtering can not be applied to the window of the impulse response\n");
+            res                 = STATUS_BAD_ARGUMENTS;
+        }
+        // Spectra of kernels which are not stored are taken from the arena before the scratch of workers
+        size_t nMark        = (arena != NULL) ? arena->nUsed : 0;
+        for (size_t i=0; (res == STATUS_OK) && (i < routes.size()); ++i)
+        {
+            size_t channel      = routes.uget(i)->nKernel;
+            if (vList[channel] != NULL)
+                continue;
+
+            if (store != NULL)
+            {
+                if ((res = acquire_kernel(cfg, store, ref, channel, radix, rank, window, &vStored[channel])) == STATUS_OK)
+                    vList[channel]      = &vStored[channel]->sKernel;
+            }
+            else if ((res = prepare_kernel(cfg, &vKernels[channel], ref, channel, radix, rank, window, arena)) == STATUS_OK)
+                vList[channel]      = &vKernels[channel];
+        }
+
+        if (res == STATUS_OK)
+            res = deconvolve_source(in, vList, nkernels, routes.array(), out,
+                deconv_threads(cfg, nInChannels, radix << rank, nkernels, partitioned),
+                (partitioned) ? 0 : lead, first, window, latency, arena);
+
+        for (size_t i=0; i < nkernels; ++i)
+        {
+            if (vStored[i] != NULL)
+                release_kernel(store, vStored[i]);
+            destroy_kernel(&vKernels[i]);
+        }
+        if (arena != NULL)
+            rewind_arena(arena, nMark);
+        delete [] vStored;
+        delete [] vList;
+        delete [] vKernels;
+
+        return res;
+    }
+
+    status_t deconvolve(const config_t *cfg, const dspu::Sample &in, const dspu::Sample &ref, dspu::Sample &out,
+        size_t lead, latency_t *latency, kernel_store_t *store, arena_t *arena)
+    {
+        source_t src;
+        src.pSample     = &in;
+        src.pMapped     = NULL;
+        src.vBuffers    = NULL;
+
+        return deconvolve_source(cfg, &src, ref, out, lead, latency, store, arena);
+    }
+
+    status_t deconvolve(const config_t *cfg, const mapped_wav_t *in, const dspu::Sample &ref, dspu::Sample &out,
+        size_t lead, latency_t *latency, kernel_store_t *store, arena_t *arena)
+    {
+        source_t src;
+        src.pSample     = NULL;
+        src.pMapped     = in;
+        src.vBuffers    = NULL;
+
+        return deconvolve_source(cfg, &src, ref, out, lead, latency, store, arena);
+    }
+
+    size_t deconv_arena_size(const config_t *cfg, size_t in_channels, size_t in_length,
+        size_t ref_channels, size_t ref_length, bool stored)
+    {
+        lltl::darray<route_t> routes;
+        if (build_routes(cfg, in_channels, ref_channels, &routes) != STATUS_OK)
+            return 0;
+
+        // Count input channels used by routes, each worker processes a pair of them
+        size_t nInputs      = 0;
+        for (size_t ch=0; ch < in_channels; ++ch)
+        {
+            for (size_t i=0, n=routes.size(); i < n; ++i)
+                if (routes.uget(i)->nInput == ch)
+                {
+                    ++nInputs;
+                    break;
+                }
+        }
+
+        size_t first = 0, window = 0;
+        bool partitioned    = ir_window(cfg, &first, &window);
+        size_t radix        = 1;
+        size_t rank         = (partitioned) ? window_rank(window) : deconv_rank(in_length, ref_length, &radix);
+        size_t threads      = deconv_threads(cfg, in_channels, radix << rank, ref_channels, partitioned);
+        size_t nWorkers     = lsp_max(lsp_min(threads, (nInputs + 1) >> 1), size_t(1));
+        size_t bytes        = arena_size<float>(worker_scratch_size(radix << rank, ref_channels, partitioned) * nWorkers);
+        if (stored)
+            return bytes;
+
+        // Spectra of distinct reference channels used by routes, the trailing silence of the reference
+        // is not known here, so the window kernel is estimated for the full length
+        size_t nFftSize     = radix << rank;
+        size_t nSpectrum    = nFftSize * 2;
+        if (partitioned)
+        {
+            size_t nBlock       = nFftSize - window + 1;
+            nSpectrum          *= lsp_max((ref_length + nBlock - 1) / nBlock, size_t(1));
+        }
+        for (size_t ch=0; ch < ref_channels; ++ch)
+        {
+            for (size_t i=0, n=routes.size(); i < n; ++i)
+                if (routes.uget(i)->nKernel == ch)
+                {
+                    bytes          += arena_size<float>(nSpectrum);
+                    break;
+                }
+        }
+
+        return bytes;
+    }
+
+    size_t ir_block_size(const config_t *cfg)
+    {
+        return lsp_max(size_t(dspu::millis_to_samples(cfg->nSampleRate, IR_BLOCK_TIME)), size_t(1));
+    }
+
+    size_t ir_decay_blocks(const float *energy, size_t count)
+    {
+        if (count < 4)
+            return count;
+
+        // Find the block with the direct sound
+        size_t peak     = 0;
+        for (size_t i=1; i<count; ++i)
+            if (energy[i] > energy[peak])
+                peak            = i;
+
+        // Estimate the noise floor as the average energy of the last 10% of the tail
+        size_t tail     = lsp_max((count - peak) / 10, size_t(1));
+        double noise    = 0.0;
+        for (size_t i=count - tail; i<count; ++i)
+            noise          += energy[i];
+        noise           = IR_NOISE_MARGIN * noise / tail;
+
+        // Find the point where the decay reaches the noise floor, the energy is smoothed
+        // over three blocks to prevent the cut at the local dip of the decay
+        for (size_t i=peak + 1; i<count - 1; ++i)
+        {
+            double e        = (double(energy[i-1]) + energy[i] + energy[i+1]) / 3.0;
+            if (e <= noise)
+                return i + 1;
+        }
+
+        return count;
+    }
+
+    size_t ir_length(const config_t *cfg, const float *energy, size_t channels, size_t length)
+    {
+        // Fixed length of the impulse response
+        if (!cfg->bIRAuto)
+        {
+            if (cfg->fIRLength <= 0.0f)
+                return length;
+            return lsp_min(size_t(dspu::millis_to_samples(cfg->nSampleRate, cfg->fIRLength)), length);
+        }
+
+        // Keep the longest decay among all channels
+        size_t block    = ir_block_size(cfg);
+        size_t blocks   = (length + block - 1) / block;
+        size_t keep     = 0;
+        for (size_t i=0; i<channels; ++i, energy += blocks)
+            keep            = lsp_max(keep, ir_decay_blocks(energy, blocks));
+
+        return lsp_min(keep * block, length);
+    }
+
+    size_t ir_length_arena_size(const config_t *cfg, size_t channels, size_t length)
+    {
+        if (!cfg->bIRAuto)
+            return 0;
+
+        size_t block    = ir_block_size(cfg);
+        size_t blocks   = (length + block - 1) / block;
+        return arena_size<float>(blocks * channels);
+    }
+
+    status_t estimate_ir_length(const config_t *cfg, const dspu::Sample &ir, size_t first, size_t length, size_t *keep,
+        arena_t *arena)
+    {
+        if (!cfg->bIRAuto)
+        {
+            *keep           = ir_length(cfg, NULL, ir.channels(), length);
             return STATUS_OK;
+        }
 
-        float peak  = 0.0f;
-        for (size_t i=0, n=dst->channels(); i<n; ++i)
+        // Compute energies of blocks
+        size_t block    = ir_block_size(cfg);
+        size_t blocks   = (length + block - 1) / block;
+        size_t channels = ir.channels();
+        uint8_t *pData  = NULL;
+        size_t mark     = (arena != NULL) ? arena->nUsed : 0;
+        float *vEnergy  = (arena != NULL) ? arena_alloc<float>(arena, blocks * channels) : NULL;
+        if ((vEnergy == NULL) && ((vEnergy = alloc_aligned<float>(pData, blocks * channels)) == NULL))
+            return STATUS_NO_MEM;
+
+        for (size_t i=0; i<channels; ++i)
         {
-            float cpeak = dsp::abs_max(dst->channel(i), dst->length());
-            peak        = lsp_max(peak, cpeak);
+            const float *src    = &ir.getBuffer(i)[first];
+            float *dst          = &vEnergy[i * blocks];
+            for (size_t j=0; j<blocks; ++j)
+                dst[j]              = dsp::h_sqr_sum(&src[j * block], lsp_min(block, length - j * block));
         }
 
+        *keep           = ir_length(cfg, vEnergy, channels, length);
+        if (pData != NULL)
+            free_aligned(pData);
+        if (arena != NULL)
+            rewind_arena(arena, mark);
+
+        return STATUS_OK;
+    }
+
+    float normalizing_gain(float peak, float gain, size_t mode)
+    {
+        if (mode == NORM_NONE)
+            return 1.0f;
+
         // No peak detected?
         if (peak < 1e-6)
-            return STATUS_OK;
+            return 1.0f;
 
         switch (mode)
         {
             case NORM_BELOW:
                 if (peak >= gain)
-                    return STATUS_OK;
+                    return 1.0f;
                 break;
             case NORM_ABOVE:
                 if (peak <= gain)
-                    return STATUS_OK;
+                    return 1.0f;
                 break;
             default:
                 break;
         }
 
+        return gain / peak;
+    }
+
+    status_t normalize(dspu::Sample *dst, float gain, size_t mode)
+    {
+        if (mode == NORM_NONE)
+            return STATUS_OK;
+
+        float peak  = 0.0f;
+        for (size_t i=0, n=dst->channels(); i<n; ++i)
+        {
+            float cpeak = dsp::abs_max(dst->channel(i), dst->length());
+            peak        = lsp_max(peak, cpeak);
+        }
+
         // Adjust gain
-        float k = gain / peak;
+        float k = normalizing_gain(peak, gain, mode);
+        if (k == 1.0f)
+            return STATUS_OK;
+
         for (size_t i=0, n=dst->channels(); i<n; ++i)
             dsp::mul_k2(dst->channel(i), k, dst->length());
 
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <private/fft.h>
+
+#define MAX_RADIX                   5           // Maximum radix of the mixed-radix transform
+#define MIXED_MIN_RANK              4           // Minimum rank of the power-of-two part of the mixed-radix transform
+#define TWIDDLE_SYNC                0x400       // Number of rotations of the twiddle factor between exact values
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    static const size_t mixed_radixes[] = { 3, 5 };
+
+    size_t mixed_fft_rank(size_t length, size_t *radix)
+    {
+        size_t rank = 0;
+        while ((size_t(1) << rank) < length)
+            ++rank;
+
+        // Select the smallest size, the power of two wins if the sizes are equal
+        size_t size = size_t(1) << rank;
+        *radix      = 1;
+        for (size_t i=0, n=sizeof(mixed_radixes)/sizeof(size_t); i<n; ++i)
+        {
+            size_t r    = mixed_radixes[i];
+            size_t k    = 0;
+            while ((r << k) < length)
+                ++k;
+            if ((k < MIXED_MIN_RANK) || ((r << k) >= size))
+                continue;
+
+            size        = r << k;
+            rank        = k;
+            *radix      = r;
+        }
+
+        return rank;
+    }
+
+    /**
+     * Compute the butterflies of the radix across radix blocks of 2^rank samples. The direct pass applies
+     * twiddle factors exp(-2*pi*i*n*k/N) after the butterflies, the reverse pass removes them before
+     * the butterflies and normalizes the result. The sample n of each block is processed independently,
+     * so the pass is computed in place.
+     */
+    static void radix_pass(float *re, float *im, size_t radix, size_t rank, bool reverse)
+    {
+        size_t nBlock   = size_t(1) << rank;
+        double sign     = (reverse) ? 1.0 : -1.0;
+        float norm      = (reverse) ? 1.0f / radix : 1.0f;
+
+        // Matrix of the butterfly: the root of unity for each output k and input j of the radix
+        float vRootRe[MAX_RADIX * MAX_RADIX], vRootIm[MAX_RADIX * MAX_RADIX];
+        for (size_t k=0; k<radix; ++k)
+        {
+            for (size_t j=0; j<radix; ++j)
+            {
+                size_t p                = (j * k) % radix;
+                vRootRe[k * radix + j]  = cos(2.0 * M_PI * p / radix);
+                vRootIm[k * radix + j]  = sign * sin(2.0 * M_PI * p / radix);
+            }
+        }
+
+        // The twiddle factor of the block k is rotated by its own step for each sample n, the rotation
+        // is periodically replaced by the exact value to prevent accumulation of the error
+        double step     = 2.0 * M_PI / (radix << rank);
+        double vDRe[MAX_RADIX], vDIm[MAX_RADIX];
+        double vWRe[MAX_RADIX], vWIm[MAX_RADIX];
+        for (size_t k=0; k<radix; ++k)
+        {
+            vDRe[k]         = cos(step * k);
+            vDIm[k]         = sign * sin(step * k);
+        }
+
+        float vXRe[MAX_RADIX], vXIm[MAX_RADIX];
+        float vTRe[MAX_RADIX], vTIm[MAX_RADIX];
+
+        for (size_t n=0; n<nBlock; ++n)
+        {
+            for (size_t k=0; k<radix; ++k)
+            {
+                if ((n % TWIDDLE_SYNC) == 0)
+                {
+                    vWRe[k]         = cos(step * (n * k));
+                    vWIm[k]         = sign * sin(step * (n * k));
+                }
+                vTRe[k]         = vWRe[k];
+                vTIm[k]         = vWIm[k];
+            }
+
+            for (size_t k=0; k<radix; ++k)
+            {
+                float xr        = re[n + k * nBlock];
+                float xi        = im[n + k * nBlock];
+                if (reverse)
+                {
+                    vXRe[k]         = xr * vTRe[k] - xi * vTIm[k];
+                    vXIm[k]         = xr * vTIm[k] + xi * vTRe[k];
+                }
+                else
+                {
+                    vXRe[k]         = xr;
+                    vXIm[k]         = xi;
+                }
+            }
+
+            for (size_t k=0; k<radix; ++k)
+            {
+                const float *rr = &vRootRe[k * radix];
+                const float *ri = &vRootIm[k * radix];
+                float yr        = 0.0f, yi = 0.0f;
+                for (size_t j=0; j<radix; ++j)
+                {
+                    yr             += vXRe[j] * rr[j] - vXIm[j] * ri[j];
+                    yi             += vXRe[j] * ri[j] + vXIm[j] * rr[j];
+                }
+
+                if (reverse)
+                {
+                    re[n + k * nBlock]  = yr * norm;
+                    im[n + k * nBlock]  = yi * norm;
+                }
+                else
+                {
+                    re[n + k * nBlock]  = yr * vTRe[k] - yi * vTIm[k];
+                    im[n + k * nBlock]  = yr * vTIm[k] + yi * vTRe[k];
+                }
+            }
+
+            for (size_t k=0; k<radix; ++k)
+            {
+                double re       = vWRe[k] * vDRe[k] - vWIm[k] * vDIm[k];
+                vWIm[k]         = vWRe[k] * vDIm[k] + vWIm[k] * vDRe[k];
+                vWRe[k]         = re;
+            }
+        }
+    }
+
+    void mixed_direct_fft(float *re, float *im, size_t radix, size_t rank)
+    {
+        // Decimation in frequency: the butterflies of the radix are followed by
+        // the power-of-two transforms of each block
+        if (radix > 1)
+            radix_pass(re, im, radix, rank, false);
+
+        size_t nBlock   = size_t(1) << rank;
+        for (size_t k=0; k<radix; ++k)
+            dsp::direct_fft(&re[k * nBlock], &im[k * nBlock], &re[k * nBlock], &im[k * nBlock], rank);
+    }
+
+    void mixed_reverse_fft(float *re, float *im, size_t radix, size_t rank)
+    {
+        size_t nBlock   = size_t(1) << rank;
+        for (size_t k=0; k<radix; ++k)
+            dsp::reverse_fft(&re[k * nBlock], &im[k * nBlock], &re[k * nBlock], &im[k * nBlock], rank);
+
+        if (radix > 1)
+            radix_pass(re, im, radix, rank, true);
+    }
+}
@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/mapped.h>
+
+#ifdef PLATFORM_WINDOWS
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif /* PLATFORM_WINDOWS */
+
+#define WAV_FORMAT_PCM          0x0001
+#define WAV_FORMAT_IEEE_FLOAT   0x0003
+#define WAV_FORMAT_EXTENSIBLE   0xfffe
+#define WAV_SIZE_UNKNOWN        0xffffffff
+#define MAPPED_BLOCK_FRAMES     0x400       /* Number of frames de-interleaved at once */
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    // WAV headers are always little-endian, read them byte by byte
+    static inline uint32_t get_le16(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8);
+    }
+
+    static inline uint32_t get_le32(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    static inline uint64_t get_le64(const uint8_t *p)
+    {
+        return uint64_t(get_le32(p)) | (uint64_t(get_le32(&p[4])) << 32);
+    }
+
+    void init_mapped_wav(mapped_wav_t *w)
+    {
+        w->nChannels    = 0;
+        w->nSampleRate  = 0;
+        w->nFrames      = 0;
+        w->nFormat      = MFMT_F32;
+        w->nSampleSize  = 0;
+        w->nFrameSize   = 0;
+        w->pFrames      = NULL;
+        w->pMap         = NULL;
+        w->nMapSize     = 0;
+        w->hFile        = NULL;
+        w->hMapping     = NULL;
+    }
+
+    static status_t map_file(mapped_wav_t *w, const LSPString *path)
+    {
+    #ifdef PLATFORM_WINDOWS
+        HANDLE fd = CreateFileW(reinterpret_cast<LPCWSTR>(path->get_utf16()), GENERIC_READ, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (fd == INVALID_HANDLE_VALUE)
+            return STATUS_IO_ERROR;
+
+        LARGE_INTEGER size;
+        if ((!GetFileSizeEx(fd, &size)) || (size.QuadPart <= 0) || (uint64_t(size.QuadPart) > uint64_t(SIZE_MAX)))
+        {
+            CloseHandle(fd);
+            return STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        HANDLE map = CreateFileMappingW(fd, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (map == NULL)
+        {
+            CloseHandle(fd);
+            return STATUS_IO_ERROR;
+        }
+
+        void *ptr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+        if (ptr == NULL)
+        {
+            CloseHandle(map);
+            CloseHandle(fd);
+            return STATUS_NO_MEM;
+        }
+
+        w->pMap         = static_cast<uint8_t *>(ptr);
+        w->nMapSize     = size.QuadPart;
+        w->hFile        = fd;
+        w->hMapping     = map;
+    #else
+        int fd = open(path->get_native(), O_RDONLY);
+        if (fd < 0)
+            return STATUS_IO_ERROR;
+
+        // Files which do not fit into the address space are read by other means
+        struct stat st;
+        if ((fstat(fd, &st) != 0) || (st.st_size <= 0) || (uint64_t(st.st_size) > uint64_t(SIZE_MAX)))
+        {
+            close(fd);
+            return STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        void *ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (ptr == MAP_FAILED)
+            return STATUS_NO_MEM;
+
+        w->pMap         = static_cast<uint8_t *>(ptr);
+        w->nMapSize     = st.st_size;
+    #endif /* PLATFORM_WINDOWS */
+
+        return STATUS_OK;
+    }
+
+    static status_t parse_format(mapped_wav_t *w, const uint8_t *fmt, size_t size)
+    {
+        if (size < 16)
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        size_t tag          = get_le16(fmt);
+        w->nChannels        = get_le16(&fmt[2]);
+        w->nSampleRate      = get_le32(&fmt[4]);
+        w->nFrameSize       = get_le16(&fmt[12]);
+        size_t bits         = get_le16(&fmt[14]);
+
+        // The extensible format stores the actual format code in the first bytes of the sub-format GUID
+        if (tag == WAV_FORMAT_EXTENSIBLE)
+        {
+            if (size < 40)
+                return STATUS_UNSUPPORTED_FORMAT;
+            tag                 = get_le16(&fmt[24]);
+        }
+
+        if ((w->nChannels <= 0) || (w->nSampleRate <= 0))
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        if (tag == WAV_FORMAT_PCM)
+        {
+            switch (bits)
+            {
+                case 8:  w->nFormat = MFMT_U8;  break;
+                case 16: w->nFormat = MFMT_S16; break;
+                case 24: w->nFormat = MFMT_S24; break;
+                case 32: w->nFormat = MFMT_S32; break;
+                default: return STATUS_UNSUPPORTED_FORMAT;
+            }
+        }
+        else if (tag == WAV_FORMAT_IEEE_FLOAT)
+        {
+            switch (bits)
+            {
+                case 32: w->nFormat = MFMT_F32; break;
+                case 64: w->nFormat = MFMT_F64; break;
+                default: return STATUS_UNSUPPORTED_FORMAT;
+            }
+        }
+        else
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        w->nSampleSize      = bits >> 3;
+        if (w->nFrameSize != w->nSampleSize * w->nChannels)
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        return STATUS_OK;
+    }
+
+    static status_t parse_header(mapped_wav_t *w)
+    {
+        const uint8_t *head = w->pMap;
+        wsize_t size        = w->nMapSize;
+        if (size < 12)
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        bool rf64           = (!memcmp(head, "RF64", 4)) || (!memcmp(head, "BW64", 4));
+        if (((!rf64) && (memcmp(head, "RIFF", 4))) || (memcmp(&head[8], "WAVE", 4)))
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        bool has_fmt        = false;
+        uint64_t data_size  = 0;        // Size of the data chunk from the ds64 chunk
+
+        for (wsize_t off = 12; off + 8 <= size; )
+        {
+            const uint8_t *chunk    = &head[off];
+            uint64_t csize          = get_le32(&chunk[4]);
+            wsize_t avail           = size - off - 8;
+
+            if (!memcmp(chunk, "ds64", 4))
+            {
+                if ((!rf64) || (csize < 24) || (csize > avail))
+                    return STATUS_UNSUPPORTED_FORMAT;
+                data_size               = get_le64(&chunk[16]);
+            }
+            else if (!memcmp(chunk, "fmt ", 4))
+            {
+                if (csize > avail)
+                    return STATUS_UNSUPPORTED_FORMAT;
+                status_t res            = parse_format(w, &chunk[8], csize);
+                if (res != STATUS_OK)
+                    return res;
+                has_fmt                 = true;
+            }
+            else if (!memcmp(chunk, "data", 4))
+            {
+                if (!has_fmt)
+                    return STATUS_UNSUPPORTED_FORMAT;
+
+                // The size of the data chunk of RF64 file is stored in the ds64 chunk,
+                // the size of the incomplete recording is limited by the file size
+                if ((rf64) && (csize == WAV_SIZE_UNKNOWN))
+                    csize                   = data_size;
+                csize                   = lsp_min(csize, uint64_t(avail));
+
+                w->pFrames              = &chunk[8];
+                w->nFrames              = csize / w->nFrameSize;
+                return STATUS_OK;
+            }
+
+            // Chunks are aligned to the word boundary
+            off                    += 8 + csize + (csize & 1);
+        }
+
+        return STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    status_t open_mapped_wav(mapped_wav_t *w, const LSPString *path)
+    {
+        init_mapped_wav(w);
+
+        status_t res = map_file(w, path);
+        if (res != STATUS_OK)
+            return res;
+
+        if ((res = parse_header(w)) != STATUS_OK)
+        {
+            close_mapped_wav(w);
+            return res;
+        }
+
+        // The default access advice is kept: rounds of channel pairs and pairs of the windowed deconvolution
+        // are read one after another through the whole file, and the sequential advice would let the system
+        // drop the pages before the next round reads them
+        return STATUS_OK;
+    }
+
+    void prefetch_mapped_wav(const mapped_wav_t *w)
+    {
+    #ifndef PLATFORM_WINDOWS
+        // The advice is asynchronous, the pages are read ahead while the caller continues
+        if (w->pMap != NULL)
+            madvise(w->pMap, w->nMapSize, MADV_WILLNEED);
+    #endif /* PLATFORM_WINDOWS */
+    }
+
+    static inline float decode_u8(const uint8_t *p)
+    {
+        return (int(p[0]) - 0x80) * (1.0f / 0x80);
+    }
+
+    static inline float decode_s16(const uint8_t *p)
+    {
+        return int16_t(get_le16(p)) * (1.0f / 0x8000);
+    }
+
+    static inline float decode_s24(const uint8_t *p)
+    {
+        return (int32_t(uint32_t(p[0] << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24)) >> 8) * (1.0f / 0x800000);
+    }
+
+    static inline float decode_s32(const uint8_t *p)
+    {
+        return int32_t(get_le32(p)) * (1.0f / 0x80000000U);
+    }
+
+    static inline float decode_f32(const uint8_t *p)
+    {
+        uint32_t v  = get_le32(p);
+        float f;
+        memcpy(&f, &v, sizeof(f));
+        return f;
+    }
+
+    static inline float decode_f64(const uint8_t *p)
+    {
+        uint64_t v  = get_le64(p);
+        double f;
+        memcpy(&f, &v, sizeof(f));
+        return f;
+    }
+
+    /**
+     * Convert the frames block by block, each block is read from the mapping once for all channels
+     * and stays in the cache while it is de-interleaved
+     */
+    template <float (* decode)(const uint8_t *)>
+        static void read_frames(const mapped_wav_t *w, float * const *dst, const size_t *channels, size_t n,
+            wsize_t first, size_t count)
+        {
+            size_t step         = w->nFrameSize;
+            const uint8_t *src  = &w->pFrames[first * step];
+
+            for (size_t off=0; off < count; off += MAPPED_BLOCK_FRAMES)
+            {
+                size_t frames       = lsp_min(count - off, size_t(MAPPED_BLOCK_FRAMES));
+                const uint8_t *block= &src[off * step];
+                for (size_t c=0; c<n; ++c)
+                {
+                    float *d            = &dst[c][off];
+                    const uint8_t *p    = &block[channels[c] * w->nSampleSize];
+                    for (size_t i=0; i<frames; ++i, p += step)
+                        d[i]                = decode(p);
+                }
+            }
+        }
+
+    void read_mapped_channels(const mapped_wav_t *w, float * const *dst, const size_t *channels, size_t n,
+        wsize_t first, size_t count)
+    {
+        switch (w->nFormat)
+        {
+            case MFMT_U8:   read_frames<decode_u8>(w, dst, channels, n, first, count); break;
+            case MFMT_S16:  read_frames<decode_s16>(w, dst, channels, n, first, count); break;
+            case MFMT_S24:  read_frames<decode_s24>(w, dst, channels, n, first, count); break;
+            case MFMT_S32:  read_frames<decode_s32>(w, dst, channels, n, first, count); break;
+            case MFMT_F32:  read_frames<decode_f32>(w, dst, channels, n, first, count); break;
+            case MFMT_F64:  read_frames<decode_f64>(w, dst, channels, n, first, count); break;
+            default:
+                break;
+        }
+    }
+
+    void close_mapped_wav(mapped_wav_t *w)
+    {
+        if (w->pMap != NULL)
+        {
+        #ifdef PLATFORM_WINDOWS
+            UnmapViewOfFile(w->pMap);
+            if (w->hMapping != NULL)
+                CloseHandle(static_cast<HANDLE>(w->hMapping));
+            if (w->hFile != NULL)
+                CloseHandle(static_cast<HANDLE>(w->hFile));
+        #else
+            munmap(w->pMap, w->nMapSize);
+        #endif /* PLATFORM_WINDOWS */
+        }
+
+        init_mapped_wav(w);
+    }
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+
+#include <private/dsp.h>
+#include <private/plan.h>
+#include <private/stream.h>
+
+#define CHUNKED_MIN_RANK        10      // Minimum block size of the chunked strategy, 1024 samples
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * Parameters of the audio file obtained from it's header
+     */
+    typedef struct file_info_t
+    {
+        size_t              nChannels;      // Number of channels
+        size_t              nSampleRate;    // Sample rate
+        wsize_t             nSrcLength;     // Length of the file in samples
+        wsize_t             nLength;        // Length of the file after resampling
+        wsize_t             nResident;      // Length of the file kept in memory while processing
+    } file_info_t;
+
+    static status_t read_file_info(const config_t *cfg, const LSPString *path, file_info_t *info)
+    {
+        mm::InAudioFileStream is;
+        status_t res = is.open(path);
+        if (res != STATUS_OK)
+            return res;
+
+        wssize_t length     = is.length();
+        info->nChannels     = is.channels();
+        info->nSampleRate   = is.sample_rate();
+        is.close();
+
+        if ((length < 0) || (info->nSampleRate <= 0))
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        // The resampled length is estimated with the small reserve for the resampling kernel
+        info->nSrcLength    = length;
+        info->nLength       = (info->nSampleRate == size_t(cfg->nSampleRate)) ?
+            length : (wsize_t(length) * cfg->nSampleRate + info->nSampleRate - 1) / info->nSampleRate + 64;
+
+        // Repetitions of the test signal are averaged while reading, so only one period is kept in memory
+        if (cfg->nRepeats > 1)
+        {
+            info->nSrcLength    = 0;
+            info->nLength       = lsp_min(info->nLength, wsize_t(sweep_period(cfg)));
+        }
+        info->nResident     = info->nLength;
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Check that the input file can be memory-mapped instead of loading, then it occupies
+     * no memory either while loading or while processing
+     */
+    static void check_mapped_input(const config_t *cfg, file_info_t *info)
+    {
+        if (cfg->nRepeats > 1)
+            return;
+
+        mapped_wav_t w;
+        init_mapped_wav(&w);
+        if (open_mapped_wav(&w, &cfg->sInFile) != STATUS_OK)
+            return;
+        if (ssize_t(w.nSampleRate) == cfg->nSampleRate)
+        {
+            info->nSrcLength    = 0;
+            info->nResident     = 0;
+        }
+        close_mapped_wav(&w);
+    }
+
+    /**
+     * Estimate memory usage of the whole-file strategy, in samples
+     */
+    static wsize_t whole_file_usage(const config_t *cfg, const file_info_t *in, const file_info_t *ref, size_t outputs, size_t workers)
+    {
+        wsize_t channels    = in->nChannels;
+        wsize_t kernels     = ref->nChannels;
+        wsize_t length      = lsp_max(in->nLength, ref->nLength);
+        wsize_t lead        = (cfg->nHarmonics > 0) ?
+            lsp_min(wsize_t(harmonic_offset(cfg, cfg->nHarmonics) + harmonic_predelay(cfg)), length - 1) : 0;
+        size_t radix        = 1;
+        size_t rank         = deconv_rank(in->nLength, ref->nLength, &radix);
+        wsize_t fft_size    = wsize_t(radix) << rank;
+
+        // Loading: the reference and the input are read at the same time, both original and resampled
+        wsize_t load        = ref->nChannels * (ref->nSrcLength + ref->nLength) + channels * (in->nSrcLength + in->nResident);
+
+        // The window of the impulse response is computed with partitioned kernels of smaller rank,
+        // each worker keeps the spectrum of the input pair and the accumulated spectrum for each kernel
+        size_t first = 0, window = 0;
+        if (ir_window(cfg, &first, &window))
+        {
+            fft_size            = wsize_t(1) << window_rank(window);
+            wsize_t blocks      = (ref->nLength + fft_size - window) / (fft_size - window + 1);
+            wsize_t process     = ref->nChannels * ref->nLength + channels * in->nResident + outputs * window +
+                                  fft_size * 2 * (kernels * blocks + workers * (2 + kernels));
+
+            return lsp_max(load, process);
+        }
+
+        // Processing: the reference, the input, the output, the kernels and the scratch buffers of workers,
+        // with several kernels each worker also keeps the spectrum of the input pair
+        wsize_t process     = ref->nChannels * ref->nLength + channels * in->nResident + outputs * (length + lead) +
+                              fft_size * 2 * (kernels + workers * ((kernels > 1) ? 2 : 1));
+
+        return lsp_max(load, process);
+    }
+
+    /**
+     * Estimate memory usage of the chunked strategy, in samples
+     */
+    static wsize_t chunked_usage(const config_t *cfg, const file_info_t *in, const file_info_t *ref, size_t rank)
+    {
+        // Loading: both original and resampled reference
+        wsize_t load        = ref->nSrcLength + ref->nLength;
+        // Processing: the same groups of channel pairs are deconvolved in one pass as the streaming deconvolution takes
+        size_t pairs        = stream_pairs(cfg, in->nChannels, in->nLength, ref->nLength, rank);
+        wsize_t process     = stream_usage(in->nChannels, ref->nLength, rank, pairs);
+
+        return lsp_max(load, process);
+    }
+
+    status_t plan_deconvolution(const config_t *cfg, plan_t *plan)
+    {
+        status_t res;
+        file_info_t in, ref;
+
+        if ((res = read_file_info(cfg, &cfg->sInFile, &in)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not read input audio file header: error code=%d\n", int(res));
+            return res;
+        }
+        check_mapped_input(cfg, &in);
+        if ((res = read_file_info(cfg, &cfg->sReference, &ref)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not read reference audio file header: error code=%d\n", int(res));
+            return res;
+        }
+
+        // The number of output channels depends on the mapping of reference channels
+        lltl::darray<route_t> routes;
+        if ((res = build_routes(cfg, in.nChannels, ref.nChannels, &routes)) != STATUS_OK)
+            return res;
+
+        wsize_t limit       = wsize_t(cfg->nMaxMemory) * 1024 * 1024 / sizeof(float);
+        wsize_t minimum     = 0;
+
+        // Whole-file strategies: try to fit as many workers as possible
+        if (!cfg->bStream)
+        {
+            size_t inputs       = (cfg->vChannels.size() > 0) ? cfg->vChannels.size() : in.nChannels;
+            size_t workers      = select_threads(cfg, (inputs + 1) >> 1);
+            for ( ; workers > 0; --workers)
+            {
+                wsize_t usage       = whole_file_usage(cfg, &in, &ref, routes.size(), workers);
+                minimum             = usage;
+                if ((limit > 0) && (usage > limit))
+                    continue;
+
+                plan->enStrategy    = (workers > 1) ? STRATEGY_WHOLE : STRATEGY_SEQUENTIAL;
+                plan->nThreads      = workers;
+                plan->nBlockSize    = 0;
+                plan->nMemory       = usage * sizeof(float);
+                return STATUS_OK;
+            }
+        }
+
+        // Chunked strategy: try to fit as large block as possible, it supports only mono reference, single sweep
+        // and the matched filter of all input channels without latency report
+        if ((cfg->nHarmonics <= 0) && (cfg->nRepeats <= 1) && (ref.nChannels == 1) && (!cfg->bMatrix) &&
+            (cfg->vRefMap.size() <= 0) && (!cfg->bRegularize) && (!cfg->bLatency) &&
+            (cfg->fWindowLength <= 0.0f) && (cfg->vChannels.size() <= 0))
+        {
+            // The kernel is split into more partitions with smaller blocks, so the memory of the kernel
+            // spectra and the delay lines does not shrink with the block, only the buffers of blocks do.
+            // The delay lines are limited by deconvolving channel pairs in several passes over the input.
+            size_t max_rank     = stream_rank(cfg->nBlockSize, ref.nLength);
+            size_t min_rank     = lsp_min(max_rank, size_t(CHUNKED_MIN_RANK));
+
+            for (ssize_t rank = max_rank; rank >= ssize_t(min_rank); --rank)
+            {
+                wsize_t usage       = chunked_usage(cfg, &in, &ref, rank);
+                minimum             = usage;
+                if ((limit > 0) && (usage > limit))
+                    continue;
+
+                plan->enStrategy    = STRATEGY_CHUNKED;
+                plan->nThreads      = 1;
+                plan->nBlockSize    = size_t(1) << rank;
+                plan->nMemory       = usage * sizeof(float);
+                return STATUS_OK;
+            }
+        }
+
+        fprintf(stderr, "Not enough memory to perform deconvolution, at least %.1f MB required\n",
+            double(minimum * sizeof(float)) / (1024.0 * 1024.0));
+
+        return STATUS_NO_MEM;
+    }
+
+    void apply_plan(config_t *cfg, const plan_t *plan)
+    {
+        cfg->nThreads       = plan->nThreads;
+        cfg->bStream        = plan->enStrategy == STRATEGY_CHUNKED;
+        cfg->nBlockSize     = plan->nBlockSize;
+    }
+
+    const char *strategy_name(strategy_t strategy)
+    {
+        switch (strategy)
+        {
+            case STRATEGY_WHOLE:        return "whole-file";
+            case STRATEGY_SEQUENTIAL:   return "per-channel sequential";
+            case STRATEGY_CHUNKED:      return "chunked";
+            default: break;
+        }
+        return "unknown";
+    }
+}
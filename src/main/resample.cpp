@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+#include <private/resample.h>
+
+#include <new>
+
+#define RESAMPLE_LOBES          32          /* Number of lobes of the Lanczos window */
+#define RESAMPLE_CUTOFF         0.95        /* Cutoff frequency relative to the Nyquist frequency */
+#define RESAMPLE_MAX_KERNEL     0x100000    /* Maximum size of the polyphase table */
+#define RESAMPLE_CHUNK_SIZE     0x2000      /* Size of the input chunk for stream resampling */
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    static size_t gcd(size_t a, size_t b)
+    {
+        while (b != 0)
+        {
+            size_t t    = a % b;
+            a           = b;
+            b           = t;
+        }
+        return a;
+    }
+
+    static inline double sinc(double x)
+    {
+        if (fabs(x) < 1e-12)
+            return 1.0;
+        x          *= M_PI;
+        return sin(x) / x;
+    }
+
+    status_t init_resampler(resampler_t *r, size_t src_rate, size_t dst_rate)
+    {
+        r->vKernel      = NULL;
+        r->pData        = NULL;
+
+        if ((src_rate <= 0) || (dst_rate <= 0))
+            return STATUS_BAD_ARGUMENTS;
+
+        size_t g        = gcd(src_rate, dst_rate);
+        r->nUp          = dst_rate / g;
+        r->nDown        = src_rate / g;
+
+        // The cutoff frequency is relative to the Nyquist frequency of the source signal,
+        // the support of the kernel grows when the signal is decimated
+        double fc       = RESAMPLE_CUTOFF * lsp_min(1.0, double(r->nUp) / double(r->nDown));
+        double width    = RESAMPLE_LOBES / fc;
+        size_t half     = size_t(ceil(width)) + 1;
+        r->nTaps        = half * 2;
+
+        size_t size     = r->nUp * r->nTaps;
+        if (size > RESAMPLE_MAX_KERNEL)
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        r->vKernel      = alloc_aligned<float>(r->pData, size);
+        if (r->vKernel == NULL)
+            return STATUS_NO_MEM;
+
+        // Phase p produces the output sample at the fractional position p/nUp between input samples,
+        // tap j is applied to the input sample at the distance (j - half + 1 - p/nUp) from it.
+        for (size_t p=0; p<r->nUp; ++p)
+        {
+            float *h        = &r->vKernel[p * r->nTaps];
+            double frac     = double(p) / double(r->nUp);
+            double sum      = 0.0;
+
+            for (size_t j=0; j<r->nTaps; ++j)
+            {
+                double t        = double(j) - double(half) + 1.0 - frac;
+                double v        = (fabs(t) < width) ? fc * sinc(fc * t) * sinc(t / width) : 0.0;
+                h[j]            = v;
+                sum            += v;
+            }
+
+            // Normalize each phase to the unity gain at DC
+            if (sum > 0.0)
+                dsp::mul_k2(h, 1.0 / sum, r->nTaps);
+        }
+
+        return STATUS_OK;
+    }
+
+    void destroy_resampler(resampler_t *r)
+    {
+        if (r->pData != NULL)
+        {
+            free_aligned(r->pData);
+            r->pData        = NULL;
+        }
+        r->vKernel      = NULL;
+    }
+
+    wsize_t resampled_length(const resampler_t *r, wsize_t length)
+    {
+        return (length * r->nUp + r->nDown - 1) / r->nDown;
+    }
+
+    /**
+     * Compute the output sample k, samples outside of the source are considered to be zero.
+     * The input samples are taken starting at the position k * nDown / nUp - half + 1
+     */
+    static inline float resample_sample(const resampler_t *r, size_t k, const float *src, size_t src_length)
+    {
+        ssize_t half    = r->nTaps >> 1;
+        wsize_t pos     = wsize_t(k) * r->nDown;
+        ssize_t start   = ssize_t(pos / r->nUp) - half + 1;
+        const float *h  = &r->vKernel[(pos % r->nUp) * r->nTaps];
+
+        if ((start >= 0) && (start + ssize_t(r->nTaps) <= ssize_t(src_length)))
+            return dsp::scalar_mul(h, &src[start], r->nTaps);
+
+        // Boundaries of the source
+        float v         = 0.0f;
+        for (size_t j=0; j<r->nTaps; ++j)
+        {
+            ssize_t idx     = start + j;
+            if ((idx >= 0) && (idx < ssize_t(src_length)))
+                v              += h[j] * src[idx];
+        }
+        return v;
+    }
+
+    /**
+     * Resample single channel
+     */
+    static void resample_channel(const resampler_t *r, float *dst, size_t dst_length, const float *src, size_t src_length)
+    {
+        for (size_t k=0; k<dst_length; ++k)
+            dst[k]          = resample_sample(r, k, src, src_length);
+    }
+
+    /**
+     * Decimate single channel in place. When nDown >= nUp, the output sample k takes input samples
+     * after the position k - half, so each output sample is delayed by half samples in the ring buffer
+     * and then overwrites the input sample which is not needed anymore.
+     */
+    static void decimate_channel(const resampler_t *r, float *buf, size_t dst_length, size_t src_length, float *ring)
+    {
+        size_t half     = r->nTaps >> 1;
+
+        for (size_t k=0; k<dst_length; ++k)
+        {
+            size_t slot     = k % half;
+            if (k >= half)
+                buf[k - half]   = ring[slot];
+            ring[slot]      = resample_sample(r, k, buf, src_length);
+        }
+
+        // Flush the delayed samples
+        for (size_t k=(dst_length > half) ? dst_length - half : 0; k<dst_length; ++k)
+            buf[k]          = ring[k % half];
+    }
+
+    /**
+     * Resampling task shared between all worker threads
+     */
+    typedef struct resample_task_t
+    {
+        const resampler_t      *pResampler;     // Resampler
+        dspu::Sample           *pSrc;           // Source sample
+        dspu::Sample           *pDst;           // Destination sample, NULL if the source is decimated in place
+        size_t                  nLength;        // Length of the result
+        float                  *vRing;          // Ring buffers of workers for the decimation in place
+        size_t                  nSlot;          // Next ring buffer to take
+        size_t                  nNext;          // Next channel to process
+        ipc::Mutex              sLock;          // Lock to fetch next channel
+    } resample_task_t;
+
+    static status_t resample_worker(void *arg)
+    {
+        resample_task_t *t  = static_cast<resample_task_t *>(arg);
+        size_t half         = t->pResampler->nTaps >> 1;
+        float *ring         = NULL;
+
+        while (true)
+        {
+            // Fetch the next channel
+            t->sLock.lock();
+            size_t ch   = t->nNext++;
+            if ((t->pDst == NULL) && (ring == NULL))
+                ring        = &t->vRing[(t->nSlot++) * half];
+            t->sLock.unlock();
+
+            if (ch >= t->pSrc->channels())
+                break;
+
+            if (t->pDst == NULL)
+                decimate_channel(t->pResampler, t->pSrc->getBuffer(ch), t->nLength, t->pSrc->length(), ring);
+            else
+                resample_channel(t->pResampler,
+                    t->pDst->getBuffer(ch), t->nLength,
+                    t->pSrc->getBuffer(ch), t->pSrc->length());
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t resample_thread(void *arg)
+    {
+        // Each additional thread should initialize DSP context
+        dsp::context_t ctx;
+        dsp::start(&ctx);
+        status_t res = resample_worker(arg);
+        dsp::finish(&ctx);
+
+        return res;
+    }
+
+    status_t resample(dspu::Sample *s, size_t srate, size_t threads)
+    {
+        // Nothing to do?
+        if (s->sample_rate() == srate)
+            return STATUS_OK;
+
+        resampler_t r;
+        status_t res = init_resampler(&r, s->sample_rate(), srate);
+        if (res == STATUS_UNSUPPORTED_FORMAT)
+        {
+            // The ratio of sample rates is too complicated, use generic resampler
+            lsp_debug("falling back to generic resampler: %d -> %d", int(s->sample_rate()), int(srate));
+            return s->resample(srate);
+        }
+        else if (res != STATUS_OK)
+            return res;
+
+        // The decimated signal is shorter than the source, so it is computed in the buffers of the
+        // source and no memory is allocated for the result. The interpolated signal needs the new buffers.
+        size_t nWorkers = lsp_max(lsp_min(threads, s->channels()), size_t(1));
+        size_t length   = resampled_length(&r, s->length());
+        bool decimate   = r.nDown >= r.nUp;
+        dspu::Sample tmp;
+        uint8_t *pData  = NULL;
+        float *vRing    = (decimate) ? alloc_aligned<float>(pData, (r.nTaps >> 1) * nWorkers) : NULL;
+        if ((decimate) ? (vRing == NULL) : (!tmp.init(s->channels(), length, length)))
+        {
+            destroy_resampler(&r);
+            return STATUS_NO_MEM;
+        }
+        tmp.set_sample_rate(srate);
+
+        resample_task_t task;
+        task.pResampler = &r;
+        task.pSrc       = s;
+        task.pDst       = (decimate) ? NULL : &tmp;
+        task.nLength    = length;
+        task.vRing      = vRing;
+        task.nSlot      = 0;
+        task.nNext      = 0;
+
+        // The calling thread works as the first worker
+        ipc::Thread **vThreads = new (std::nothrow) ipc::Thread *[nWorkers];
+        if (vThreads == NULL)
+        {
+            if (pData != NULL)
+                free_aligned(pData);
+            destroy_resampler(&r);
+            return STATUS_NO_MEM;
+        }
+
+        for (size_t i = 1; i < nWorkers; ++i)
+        {
+            vThreads[i]     = new (std::nothrow) ipc::Thread(resample_thread, &task);
+            if ((vThreads[i] != NULL) && (vThreads[i]->start() != STATUS_OK))
+            {
+                delete vThreads[i];
+                vThreads[i]     = NULL;
+            }
+        }
+
+        // Even if some threads have failed to start, the work will be completed by the rest
+        resample_worker(&task);
+
+        for (size_t i = 1; i < nWorkers; ++i)
+        {
+            if (vThreads[i] == NULL)
+                continue;
+            vThreads[i]->join();
+            delete vThreads[i];
+        }
+
+        delete [] vThreads;
+        destroy_resampler(&r);
+
+        if (decimate)
+        {
+            free_aligned(pData);
+            s->set_length(length);
+            s->set_sample_rate(srate);
+        }
+        else
+            s->swap(&tmp);
+
+        return STATUS_OK;
+    }
+
+    status_t init_resample_stream(resample_stream_t *rs, mm::IInAudioStream *is, size_t srate)
+    {
+        rs->pIn         = is;
+        rs->vChunk      = NULL;
+        rs->vHistory    = NULL;
+        rs->pData       = NULL;
+
+        wssize_t length = is->length();
+        if (length < 0)
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        status_t res    = init_resampler(&rs->sResampler, is->sample_rate(), srate);
+        if (res != STATUS_OK)
+            return res;
+
+        rs->nChannels   = is->channels();
+        rs->nChunk      = RESAMPLE_CHUNK_SIZE;
+        rs->nCapacity   = rs->nChunk + rs->sResampler.nTaps;
+        rs->nOut        = 0;
+        rs->nLength     = resampled_length(&rs->sResampler, length);
+        rs->bEof        = false;
+
+        // Allocate buffers:
+        // 1X Interleaved input chunk, of size nChunk * nChannels
+        // nChannels X History, of size nCapacity
+        size_t nTotal   = rs->nChunk * rs->nChannels + rs->nCapacity * rs->nChannels;
+        float *ptr      = alloc_aligned<float>(rs->pData, nTotal);
+        if (ptr == NULL)
+        {
+            destroy_resampler(&rs->sResampler);
+            return STATUS_NO_MEM;
+        }
+
+        rs->vChunk      = ptr;
+        ptr            += rs->nChunk * rs->nChannels;
+        rs->vHistory    = ptr;
+        ptr            += rs->nCapacity * rs->nChannels;
+
+        // The history starts with zeros before the first sample of the stream
+        rs->nAvail      = rs->sResampler.nTaps;
+        rs->nBase       = -ssize_t(rs->nAvail);
+        dsp::fill_zero(rs->vHistory, rs->nCapacity * rs->nChannels);
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Drop samples before the specified position from the history and append the next chunk
+     * of the input stream. After the end of the stream, zeros are appended.
+     */
+    static status_t fill_history(resample_stream_t *rs, wssize_t start)
+    {
+        // Drop samples that are not required anymore
+        if (start > rs->nBase)
+        {
+            size_t shift    = lsp_min(size_t(start - rs->nBase), rs->nAvail);
+            for (size_t c=0; c<rs->nChannels; ++c)
+            {
+                float *hist     = &rs->vHistory[c * rs->nCapacity];
+                dsp::move(hist, &hist[shift], rs->nAvail - shift);
+            }
+            rs->nBase      += shift;
+            rs->nAvail     -= shift;
+        }
+
+        size_t count    = lsp_min(rs->nChunk, rs->nCapacity - rs->nAvail);
+        if (!rs->bEof)
+        {
+            ssize_t nread   = rs->pIn->read(rs->vChunk, count);
+            if (nread < 0)
+            {
+                if (nread != -STATUS_EOF)
+                    return status_t(-nread);
+                rs->bEof        = true;
+            }
+            else if (nread == 0)
+                rs->bEof        = true;
+            else
+            {
+                // De-interleave the chunk
+                for (size_t c=0; c<rs->nChannels; ++c)
+                {
+                    float *dst      = &rs->vHistory[c * rs->nCapacity + rs->nAvail];
+                    const float *src= &rs->vChunk[c];
+                    for (ssize_t i=0; i<nread; ++i, src += rs->nChannels)
+                        dst[i]          = *src;
+                }
+                rs->nAvail     += nread;
+                return STATUS_OK;
+            }
+        }
+
+        // Pad with zeros after the end of stream
+        for (size_t c=0; c<rs->nChannels; ++c)
+            dsp::fill_zero(&rs->vHistory[c * rs->nCapacity + rs->nAvail], count);
+        rs->nAvail     += count;
+
+        return STATUS_OK;
+    }
+
+    status_t resample_stream_read(resample_stream_t *rs, float *dst, size_t frames, size_t *count)
+    {
+        const resampler_t *r    = &rs->sResampler;
+        ssize_t half            = r->nTaps >> 1;
+        frames                  = lsp_min(wsize_t(frames), rs->nLength - rs->nOut);
+
+        for (size_t i=0; i<frames; ++i, ++rs->nOut, dst += rs->nChannels)
+        {
+            wsize_t pos     = rs->nOut * r->nDown;
+            wssize_t start  = wssize_t(pos / r->nUp) - half + 1;
+            const float *h  = &r->vKernel[(pos % r->nUp) * r->nTaps];
+
+            // Ensure that all samples required for the output sample are present in the history
+            while (start + wssize_t(r->nTaps) > rs->nBase + wssize_t(rs->nAvail))
+            {
+                status_t res    = fill_history(rs, start);
+                if (res != STATUS_OK)
+                {
+                    *count          = i;
+                    return res;
+                }
+            }
+
+            const float *src    = &rs->vHistory[start - rs->nBase];
+            for (size_t c=0; c<rs->nChannels; ++c, src += rs->nCapacity)
+                dst[c]              = dsp::scalar_mul(h, src, r->nTaps);
+        }
+
+        *count      = frames;
+        return STATUS_OK;
+    }
+
+    void destroy_resample_stream(resample_stream_t *rs)
+    {
+        destroy_resampler(&rs->sResampler);
+        if (rs->pData != NULL)
+        {
+            free_aligned(rs->pData);
+            rs->pData       = NULL;
+        }
+        rs->vChunk      = NULL;
+        rs->vHistory    = NULL;
+    }
+}
@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/cache.h>
+#include <private/cmdline.h>
+#include <private/dsp.h>
+#include <private/serve.h>
+#include <private/stats.h>
+#include <private/tool.h>
+
+#include <new>
+
+#ifndef PLATFORM_WINDOWS
+    #include <errno.h>
+    #include <stdlib.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+#endif /* PLATFORM_WINDOWS */
+
+#define MAX_JOB_LINE            0x10000
+
+namespace room_raider
+{
+    using namespace lsp;
+
+#ifdef PLATFORM_WINDOWS
+    status_t serve(const config_t *cfg)
+    {
+        fprintf(stderr, "Server mode is not supported on this platform\n");
+        return STATUS_NOT_SUPPORTED;
+    }
+#else
+    /**
+     * Server state shared between worker threads
+     */
+    typedef struct server_t
+    {
+        int                         hSocket;        // Listening socket
+        bool                        bStop;          // Shutdown has been requested
+        bool                        bHugePages;     // Back the memory of jobs with huge pages
+        ref_cache_t                 sCache;         // References shared between jobs
+        ipc::Mutex                  sLock;          // Lock to access the shutdown request
+    } server_t;
+
+    /**
+     * Connection of the client
+     */
+    typedef struct client_t
+    {
+        int                         hSocket;        // Connected socket
+        bool                        bError;         // The client has gone, further replies are dropped
+    } client_t;
+
+    static void send_reply(client_t *c, const LSPString *text)
+    {
+    #ifdef MSG_NOSIGNAL
+        const int flags     = MSG_NOSIGNAL;
+    #else
+        const int flags     = 0;
+    #endif /* MSG_NOSIGNAL */
+
+        const char *buf     = text->get_native();
+        size_t len          = (buf != NULL) ? strlen(buf) : 0;
+
+        while ((!c->bError) && (len > 0))
+        {
+            ssize_t n           = send(c->hSocket, buf, len, flags);
+            if (n < 0)
+            {
+                if (errno != EINTR)
+                    c->bError           = true;
+                continue;
+            }
+            buf                += n;
+            len                -= n;
+        }
+    }
+
+    static void send_status(client_t *c, const char *reply, status_t code)
+    {
+        LSPString line;
+        if (line.fmt_ascii("%s %d\n", reply, int(code)))
+            send_reply(c, &line);
+    }
+
+    /**
+     * Report each stage of the job to the client as soon as it has been finished
+     */
+    static void stage_hook(const stage_t *st, void *arg)
+    {
+        client_t *c         = static_cast<client_t *>(arg);
+        LSPString line;
+        if (line.fmt_ascii("STAGE %s channels=%llu wall=%.6f cpu=%.6f process_cpu=%.6f read=%llu written=%llu\n",
+            st->sName, (unsigned long long)st->nChannels, st->fWall, st->fCpu, st->fProcessCpu,
+            (unsigned long long)st->nRead, (unsigned long long)st->nWritten))
+            send_reply(c, &line);
+    }
+
+    static bool is_stopped(server_t *s)
+    {
+        s->sLock.lock();
+        bool stop           = s->bStop;
+        s->sLock.unlock();
+        return stop;
+    }
+
+    static void stop_server(server_t *s)
+    {
+        s->sLock.lock();
+        s->bStop            = true;
+        // Wake up all workers waiting for the connection
+        shutdown(s->hSocket, SHUT_RDWR);
+        s->sLock.unlock();
+    }
+
+    /**
+     * Read the single line of the request, the rest of data sent by the client is ignored
+     */
+    static status_t read_request(client_t *c, char *buf, size_t size)
+    {
+        size_t len          = 0;
+        while (true)
+        {
+            if (len >= size)
+                return STATUS_OVERFLOW;
+
+            ssize_t n           = recv(c->hSocket, &buf[len], size - len, 0);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return STATUS_IO_ERROR;
+            }
+            else if (n == 0)
+            {
+                if (len <= 0)
+                    return STATUS_EOF;
+                break;
+            }
+
+            char *eol           = static_cast<char *>(memchr(&buf[len], '\n', n));
+            len                += n;
+            if (eol != NULL)
+            {
+                len                 = eol - buf;
+                break;
+            }
+        }
+
+        // Remove trailing line break and spaces
+        while ((len > 0) && ((buf[len-1] == '\r') || (buf[len-1] == ' ') || (buf[len-1] == '\t')))
+            --len;
+        buf[len]            = '\0';
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Split the line into arguments in place. Arguments are separated by spaces, double quotes
+     * allow spaces inside the argument, the quote and the backslash can be escaped with the
+     * backslash inside quotes.
+     */
+    static status_t split_args(char *s, lltl::parray<char> *args)
+    {
+        char *dst           = s;
+        while (true)
+        {
+            while ((*s == ' ') || (*s == '\t'))
+                ++s;
+            if (*s == '\0')
+                break;
+
+            char *arg           = dst;
+            bool quoted         = false;
+            for ( ; *s != '\0'; ++s)
+            {
+                if (*s == '"')
+                {
+                    quoted              = !quoted;
+                    continue;
+                }
+                if ((!quoted) && ((*s == ' ') || (*s == '\t')))
+                    break;
+                if ((quoted) && (*s == '\\') && ((s[1] == '"') || (s[1] == '\\')))
+                    ++s;
+                *(dst++)            = *s;
+            }
+            if (quoted)
+                return STATUS_BAD_FORMAT;
+
+            bool more           = *s != '\0';
+            if (more)
+                ++s;
+            *(dst++)            = '\0';
+
+            if (!args->add(arg))
+                return STATUS_NO_MEM;
+            if (!more)
+                break;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t run_job(server_t *s, client_t *c, char *line, arena_t *arena)
+    {
+        status_t res;
+        lltl::parray<char> args;
+        if (!args.add(const_cast<char *>("room-raider")))
+            return STATUS_NO_MEM;
+        if ((res = split_args(line, &args)) != STATUS_OK)
+        {
+            fprintf(stderr, "Invalid job arguments: %s\n", line);
+            return res;
+        }
+
+        // Jobs are already processed in parallel, so each job uses one thread unless specified
+        config_t cfg;
+        cfg.nThreads        = 1;
+        if ((res = parse_cmdline(&cfg, args.size(), const_cast<const char **>(args.array()))) != STATUS_OK)
+            return res;
+        if (cfg.enMode == M_SERVE)
+        {
+            fprintf(stderr, "Server mode can not be selected for the job\n");
+            return STATUS_BAD_ARGUMENTS;
+        }
+        if ((res = check_config(&cfg)) != STATUS_OK)
+            return res;
+
+        // Stages are always reported to the client
+        stats_t stats;
+        init_stats(&stats, &cfg);
+        stats.bEnabled      = true;
+        stats.pHook         = stage_hook;
+        stats.pHookArg      = c;
+
+        LSPString reply;
+        if (!reply.set_ascii("ACCEPTED\n"))
+            return STATUS_NO_MEM;
+        send_reply(c, &reply);
+
+        if ((res = process(&cfg, &stats, &s->sCache, arena)) != STATUS_OK)
+            return res;
+
+        // Requested statistics are sent to the client as a single line if the file is not specified
+        if (cfg.nStats == STATS_NONE)
+            return STATUS_OK;
+        if (!cfg.sStatsFile.is_empty())
+            return write_stats(&stats, &cfg);
+
+        if ((!reply.set_ascii("STATS ")) || (!format_stats(&reply, &stats, &cfg)))
+            return STATUS_NO_MEM;
+        reply.replace_all('\n', ' ');
+        reply.trim();
+        if (!reply.append('\n'))
+            return STATUS_NO_MEM;
+        send_reply(c, &reply);
+
+        return STATUS_OK;
+    }
+
+    static void serve_client(server_t *s, client_t *c, arena_t *arena)
+    {
+        char *line          = static_cast<char *>(malloc(MAX_JOB_LINE + 1));
+        if (line == NULL)
+        {
+            send_status(c, "DONE", STATUS_NO_MEM);
+            return;
+        }
+
+        status_t res        = read_request(c, line, MAX_JOB_LINE);
+        if (res == STATUS_OK)
+        {
+            if (!strcmp(line, "SHUTDOWN"))
+                stop_server(s);
+            else
+                res                 = run_job(s, c, line, arena);
+            send_status(c, "DONE", res);
+        }
+        else if (res != STATUS_EOF)
+            send_status(c, "DONE", res);
+
+        free(line);
+    }
+
+    static status_t serve_worker(void *arg)
+    {
+        server_t *s         = static_cast<server_t *>(arg);
+
+        // Each worker thread should initialize DSP context
+        dsp::context_t ctx;
+        dsp::start(&ctx);
+
+        // The memory of the worker is reserved once and reused by all it's jobs
+        arena_t arena;
+        init_arena(&arena, s->bHugePages);
+
+        while (true)
+        {
+            int fd              = accept(s->hSocket, NULL, NULL);
+            if (fd < 0)
+            {
+                if (is_stopped(s))
+                    break;
+                if ((errno == EINTR) || (errno == ECONNABORTED))
+                    continue;
+
+                fprintf(stderr, "Could not accept connection: errno=%d\n", errno);
+                stop_server(s);
+                break;
+            }
+
+            client_t c;
+            c.hSocket           = fd;
+            c.bError            = false;
+            serve_client(s, &c, &arena);
+            reset_arena(&arena);
+            close(fd);
+        }
+
+        destroy_arena(&arena);
+        dsp::finish(&ctx);
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Remove the socket left by the previous instance of the server. Files which are not sockets
+     * and sockets of the running server are never removed.
+     */
+    static status_t remove_stale_socket(const char *path, const struct sockaddr_un *addr)
+    {
+        struct stat st;
+        if (lstat(path, &st) < 0)
+            return (errno == ENOENT) ? STATUS_OK : STATUS_IO_ERROR;
+        if (!S_ISSOCK(st.st_mode))
+            return STATUS_ALREADY_EXISTS;
+
+        // The socket is stale if nobody accepts connections at it
+        int fd              = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return STATUS_IO_ERROR;
+        bool alive          = connect(fd, reinterpret_cast<const struct sockaddr *>(addr), sizeof(*addr)) == 0;
+        close(fd);
+        if (alive)
+            return STATUS_ALREADY_EXISTS;
+
+        return (unlink(path) < 0) ? STATUS_IO_ERROR : STATUS_OK;
+    }
+
+    status_t serve(const config_t *cfg)
+    {
+        if (cfg->sServe.is_empty())
+        {
+            fprintf(stderr, "Not specified socket path of the server\n");
+            return STATUS_INVALID_VALUE;
+        }
+        if (cfg->nServeCache < 0)
+        {
+            fprintf(stderr, "Invalid size of the reference cache\n");
+            return STATUS_INVALID_VALUE;
+        }
+
+        struct sockaddr_un addr;
+        const char *path    = cfg->sServe.get_native();
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family     = AF_UNIX;
+        if (strlen(path) >= sizeof(addr.sun_path))
+        {
+            fprintf(stderr, "Too long socket path of the server\n");
+            return STATUS_INVALID_VALUE;
+        }
+        strcpy(addr.sun_path, path);
+
+        server_t s;
+        s.bStop             = false;
+        s.bHugePages        = cfg->bHugePages;
+        init_ref_cache(&s.sCache, cfg->nServeCache);
+        s.hSocket           = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s.hSocket < 0)
+        {
+            fprintf(stderr, "Could not create socket: errno=%d\n", errno);
+            return STATUS_IO_ERROR;
+        }
+
+        status_t res        = remove_stale_socket(path, &addr);
+        if (res != STATUS_OK)
+        {
+            if (res == STATUS_ALREADY_EXISTS)
+                fprintf(stderr, "Could not listen at socket %s: address in use\n", path);
+            else
+                fprintf(stderr, "Could not remove stale socket %s: errno=%d\n", path, errno);
+            close(s.hSocket);
+            return res;
+        }
+
+        // Any client connected to the socket can submit jobs with the rights of the server and stop it,
+        // so the socket is accessible only to the owner. Worker threads are not started yet, so the umask
+        // of the process can be changed for the bind() call.
+        ::mode_t mask       = umask(S_IRWXG | S_IRWXO);
+        int bound           = bind(s.hSocket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        umask(mask);
+        if ((bound < 0) || (chmod(path, S_IRUSR | S_IWUSR) < 0) || (listen(s.hSocket, SOMAXCONN) < 0))
+        {
+            fprintf(stderr, "Could not listen at socket %s: errno=%d\n", path, errno);
+            close(s.hSocket);
+            if (bound >= 0)
+                unlink(path);
+            return STATUS_IO_ERROR;
+        }
+
+        // Each worker processes one connection at a time
+        size_t nWorkers     = select_threads(cfg, size_t(-1));
+        printf("Serving jobs at %s, concurrent jobs: %d\n", path, int(nWorkers));
+
+        lltl::parray<ipc::Thread> threads;
+        for (size_t i=0; i<nWorkers; ++i)
+        {
+            ipc::Thread *t  = new (std::nothrow) ipc::Thread(serve_worker, &s);
+            if (t == NULL)
+                break;
+            if ((!threads.add(t)) || (t->start() != STATUS_OK))
+            {
+                threads.premove(t);
+                delete t;
+                break;
+            }
+        }
+
+        // If no threads have been started, serve connections in the calling thread
+        if (threads.size() <= 0)
+            serve_worker(&s);
+
+        for (size_t i=0, n=threads.size(); i<n; ++i)
+        {
+            ipc::Thread *t  = threads.uget(i);
+            t->join();
+            delete t;
+        }
+        threads.flush();
+
+        close(s.hSocket);
+        unlink(path);
+        destroy_ref_cache(&s.sCache);
+
+        return STATUS_OK;
+    }
+#endif /* PLATFORM_WINDOWS */
+}
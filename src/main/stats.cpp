@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/io/File.h>
+#include <lsp-plug.in/runtime/system.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/stats.h>
+
+#ifdef PLATFORM_WINDOWS
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif /* PLATFORM_WINDOWS */
+
+namespace room_raider
+{
+    using namespace lsp;
+
+#ifdef PLATFORM_WINDOWS
+    static double filetime_seconds(const FILETIME *kernel, const FILETIME *user)
+    {
+        // FILETIME is measured in 100-nanosecond intervals
+        wsize_t k       = (wsize_t(kernel->dwHighDateTime) << 32) | kernel->dwLowDateTime;
+        wsize_t x       = (wsize_t(user->dwHighDateTime) << 32) | user->dwLowDateTime;
+        return double(k + x) * 1e-7;
+    }
+#else
+    static double rusage_seconds(const struct rusage *ru)
+    {
+        return double(ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) +
+               double(ru->ru_utime.tv_usec + ru->ru_stime.tv_usec) * 1e-6;
+    }
+#endif /* PLATFORM_WINDOWS */
+
+    /**
+     * Get the CPU time of the calling thread, so stages running concurrently in different
+     * threads do not include the time of each other
+     */
+    static double thread_cpu_time()
+    {
+    #if defined(PLATFORM_WINDOWS)
+        FILETIME ctime, etime, ktime, utime;
+        if (GetThreadTimes(GetCurrentThread(), &ctime, &etime, &ktime, &utime))
+            return filetime_seconds(&ktime, &utime);
+    #elif defined(RUSAGE_THREAD)
+        struct rusage ru;
+        if (getrusage(RUSAGE_THREAD, &ru) == 0)
+            return rusage_seconds(&ru);
+    #elif defined(CLOCK_THREAD_CPUTIME_ID)
+        struct timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+            return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+    #endif /* PLATFORM_WINDOWS */
+        return 0.0;
+    }
+
+    wsize_t available_memory()
+    {
+    #if defined(PLATFORM_WINDOWS)
+        MEMORYSTATUSEX ms;
+        ms.dwLength     = sizeof(ms);
+        if (GlobalMemoryStatusEx(&ms))
+            return ms.ullAvailPhys;
+    #else
+        #if defined(PLATFORM_LINUX)
+            // The free memory does not include the page cache which can be dropped, so take the estimate of the kernel
+            FILE *fd = fopen("/proc/meminfo", "r");
+            if (fd != NULL)
+            {
+                char line[128];
+                unsigned long long kb = 0;
+                bool found      = false;
+                while ((!found) && (fgets(line, sizeof(line), fd) != NULL))
+                    found           = sscanf(line, "MemAvailable: %llu kB", &kb) == 1;
+                fclose(fd);
+                if (found)
+                    return wsize_t(kb) * 1024;
+            }
+        #endif /* PLATFORM_LINUX */
+        #if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+            long pages      = sysconf(_SC_AVPHYS_PAGES);
+            long size       = sysconf(_SC_PAGESIZE);
+            if ((pages > 0) && (size > 0))
+                return wsize_t(pages) * wsize_t(size);
+        #endif /* _SC_AVPHYS_PAGES */
+    #endif /* PLATFORM_WINDOWS */
+        return 0;
+    }
+
+    void get_usage(usage_t *u)
+    {
+        system::time_t now;
+        system::get_time(&now);
+        u->fWall        = double(now.seconds) + double(now.nanos) * 1e-9;
+        u->fThreadCpu   = thread_cpu_time();
+
+    #ifdef PLATFORM_WINDOWS
+        FILETIME ctime, etime, ktime, utime;
+        PROCESS_MEMORY_COUNTERS mem;
+
+        u->fCpu         = 0.0;
+        u->nPeakRSS     = 0;
+        if (GetProcessTimes(GetCurrentProcess(), &ctime, &etime, &ktime, &utime))
+            u->fCpu         = filetime_seconds(&ktime, &utime);
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &mem, sizeof(mem)))
+            u->nPeakRSS     = mem.PeakWorkingSetSize;
+    #else
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) == 0)
+        {
+            u->fCpu         = rusage_seconds(&ru);
+        #ifdef PLATFORM_MACOSX
+            u->nPeakRSS     = ru.ru_maxrss;         // Reported in bytes
+        #else
+            u->nPeakRSS     = wsize_t(ru.ru_maxrss) * 1024; // Reported in kilobytes
+        #endif /* PLATFORM_MACOSX */
+        }
+        else
+        {
+            u->fCpu         = 0.0;
+            u->nPeakRSS     = 0;
+        }
+    #endif /* PLATFORM_WINDOWS */
+    }
+
+    void init_stats(stats_t *s, const config_t *cfg)
+    {
+        s->bEnabled     = cfg->nStats != STATS_NONE;
+        s->vStages.flush();
+        s->pHook        = NULL;
+        s->pHookArg     = NULL;
+        get_usage(&s->sStart);
+    }
+
+    void stage_begin(const stats_t *s, usage_t *u)
+    {
+        if (s->bEnabled)
+            get_usage(u);
+    }
+
+    void stage_end(stats_t *s, const usage_t *u, const char *name, size_t channels, wsize_t read, wsize_t written)
+    {
+        if (!s->bEnabled)
+            return;
+
+        usage_t now;
+        get_usage(&now);
+
+        // Statistics are optional, so the failed allocation is not an error.
+        // The hook is called under the lock, so it is never called concurrently.
+        s->sLock.lock();
+        stage_t *st     = s->vStages.add();
+        if (st != NULL)
+        {
+            st->sName       = name;
+            st->nChannels   = channels;
+            st->fWall       = now.fWall - u->fWall;
+            st->fCpu        = now.fThreadCpu - u->fThreadCpu;
+            st->fProcessCpu = now.fCpu - u->fCpu;
+            st->nRead       = read;
+            st->nWritten    = written;
+            st->nPeakRSS    = now.nPeakRSS;
+
+            if (s->pHook != NULL)
+                s->pHook(st, s->pHookArg);
+        }
+        s->sLock.unlock();
+    }
+
+    wsize_t file_size(const LSPString *path)
+    {
+        io::fattr_t attr;
+        if (io::File::stat(path, &attr) != STATUS_OK)
+            return 0;
+        return attr.size;
+    }
+
+    bool format_stats(LSPString *out, const stats_t *s, const config_t *cfg)
+    {
+        static const char *modes[] = { "none", "sweep", "deconvolve", "batch", "serve" };
+
+        usage_t now;
+        get_usage(&now);
+
+        wsize_t read = 0, written = 0;
+        bool ok = out->fmt_append_ascii("{\n  \"mode\": \"%s\",\n  \"stages\": [", modes[cfg->enMode]);
+
+        for (size_t i=0, n=s->vStages.size(); (ok) && (i<n); ++i)
+        {
+            const stage_t *st   = s->vStages.uget(i);
+            read               += st->nRead;
+            written            += st->nWritten;
+
+            ok = out->fmt_append_ascii(
+                "%s\n    { \"name\": \"%s\", \"channels\": %llu, \"wall\": %.6f, \"cpu\": %.6f, \"process_cpu\": %.6f, "
+                "\"read\": %llu, \"written\": %llu, \"peak_rss\": %llu }",
+                (i > 0) ? "," : "",
+                st->sName, (unsigned long long)st->nChannels, st->fWall, st->fCpu, st->fProcessCpu,
+                (unsigned long long)st->nRead, (unsigned long long)st->nWritten, (unsigned long long)st->nPeakRSS);
+        }
+
+        if (ok)
+            ok = out->fmt_append_ascii(
+                "\n  ],\n  \"total\": { \"wall\": %.6f, \"cpu\": %.6f, \"read\": %llu, \"written\": %llu, \"peak_rss\": %llu }\n}\n",
+                now.fWall - s->sStart.fWall, now.fCpu - s->sStart.fCpu,
+                (unsigned long long)read, (unsigned long long)written, (unsigned long long)now.nPeakRSS);
+
+        return ok;
+    }
+
+    /**
+     * Write the report to the sidecar file or print it if the file is not specified
+     */
+    static status_t write_report(const LSPString *out, const LSPString *path)
+    {
+        if (path->is_empty())
+        {
+            fputs(out->get_native(), stdout);
+            return STATUS_OK;
+        }
+
+        FILE *fd = fopen(path->get_native(), "w");
+        if (fd == NULL)
+            return STATUS_IO_ERROR;
+
+        const char *text = out->get_native();
+        bool ok = fputs(text, fd) >= 0;
+        ok = (fclose(fd) == 0) && (ok);
+
+        return (ok) ? STATUS_OK : STATUS_IO_ERROR;
+    }
+
+    status_t write_stats(const stats_t *s, const config_t *cfg)
+    {
+        if (!s->bEnabled)
+            return STATUS_OK;
+
+        LSPString out;
+        if (!format_stats(&out, s, cfg))
+            return STATUS_NO_MEM;
+
+        return write_report(&out, &cfg->sStatsFile);
+    }
+
+    status_t write_latency(const config_t *cfg, const route_t *routes, const latency_t *latency, size_t count)
+    {
+        LSPString out;
+        bool ok = out.append_ascii("channel,input,reference,latency_samples,latency_ms,relative_ms,polarity\n");
+
+        double kt = 1000.0 / cfg->nSampleRate;
+        for (size_t i=0; (ok) && (i < count); ++i)
+        {
+            // The alignment is computed relative to the earliest channel with the same reference
+            float first = latency[i].fDelay;
+            for (size_t j=0; j < count; ++j)
+                if (routes[j].nKernel == routes[i].nKernel)
+                    first       = lsp_min(first, latency[j].fDelay);
+
+            ok = out.fmt_append_ascii("%d,%d,%d,%.3f,%.4f,%.4f,%c\n",
+                int(i), int(routes[i].nInput), int(routes[i].nKernel),
+                latency[i].fDelay, latency[i].fDelay * kt, (latency[i].fDelay - first) * kt,
+                (latency[i].fPeak < 0.0f) ? '-' : '+');
+        }
+        if (!ok)
+            return STATUS_NO_MEM;
+
+        return write_report(&out, &cfg->sLatencyFile);
+    }
+}
@@ -0,0 +1,843 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+#include <lsp-plug.in/mm/OutAudioFileStream.h>
+
+#include <private/dsp.h>
+#include <private/resample.h>
+#include <private/stream.h>
+#include <private/writer.h>
+
+#include <new>
+
+#define SWEEP_FILE_BLOCK_SIZE       0x4000
+#define STREAM_BLOCK_SIZE           0x10000     // Default block size of the streaming deconvolution
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    /**
+     * State of the streaming deconvolution
+     */
+    typedef struct stream_t
+    {
+        mm::InAudioFileStream   sIn;            // Input stream
+        resample_stream_t       sResample;      // Resampler of the input stream
+        resample_stream_t      *pResample;      // Resampler, NULL if the sample rate of the input matches
+        size_t                  nChannels;      // Number of input channels
+        size_t                  nOutLength;     // Length of the output
+        size_t                  nOrigin;        // Origin of time in the result
+        size_t                  nResult;        // Number of samples of the result to compute
+        size_t                  nRank;          // Rank of the transform
+        size_t                  nFftSize;       // Size of the transform
+        size_t                  nBlock;         // Size of the block, half of the transform
+        size_t                  nParts;         // Number of kernel partitions
+        size_t                  nIRBlock;       // Size of the block for the impulse response truncation
+        size_t                  nIRBlocks;      // Number of blocks for the impulse response truncation, 0 if disabled
+        float                  *vKernelRe;      // Spectra of the kernel partitions, real part
+        float                  *vKernelIm;      // Spectra of the kernel partitions, imaginary part
+        float                  *vRe;            // Working buffer, real part
+        float                  *vIm;            // Working buffer, imaginary part
+        float                  *vAccRe;         // Accumulator, real part
+        float                  *vAccIm;         // Accumulator, imaginary part
+        float                  *vDelayRe;       // Delay lines of the segment spectra, real part
+        float                  *vDelayIm;       // Delay lines of the segment spectra, imaginary part
+        float                  *vHistory;       // Previous block of each channel of the pass
+        float                  *vFrames;        // Interleaved frames of the input block
+        float                  *vPeak;          // Peak of the whole result of each channel
+        float                  *vWinPeak;       // Peak of the part written to the output file of each channel
+        float                  *vGain;          // Output gain of each channel
+        float                  *vEnergy;        // Energies of the output blocks of each channel
+    } stream_t;
+
+    /**
+     * Read the requested number of frames from the stream, the number of read frames
+     * may be less than requested only when the end of stream has been reached.
+     *
+     * @param is input stream
+     * @param dst destination buffer to store interleaved frames
+     * @param frames number of frames to read
+     * @param count pointer to store number of frames actually read
+     * @return status of operation
+     */
+    static status_t read_frames(mm::IInAudioStream *is, float *dst, size_t frames, size_t *count)
+    {
+        size_t channels = is->channels();
+        size_t offset   = 0;
+
+        while (offset < frames)
+        {
+            ssize_t nread   = is->read(&dst[offset * channels], frames - offset);
+            if (nread < 0)
+            {
+                if (nread == -STATUS_EOF)
+                    break;
+                return status_t(-nread);
+            }
+            else if (nread == 0)
+                break;
+
+            offset         += nread;
+        }
+
+        *count  = offset;
+        return STATUS_OK;
+    }
+
+    /**
+     * Write all the frames to the output stream
+     *
+     * @param os output stream
+     * @param src interleaved frames
+     * @param channels number of channels
+     * @param frames number of frames to write
+     * @return status of operation
+     */
+    static status_t write_frames(mm::IOutAudioStream *os, const float *src, size_t channels, size_t frames)
+    {
+        while (frames > 0)
+        {
+            ssize_t nwritten = os->write(src, frames);
+            if (nwritten < 0)
+                return status_t(-nwritten);
+            else if (nwritten == 0)
+                return STATUS_IO_ERROR;
+
+            src            += nwritten * channels;
+            frames         -= nwritten;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t open_output(mm::OutAudioFileStream *os, const LSPString *path, size_t channels, size_t srate, wssize_t frames)
+    {
+        mm::audio_stream_t fmt;
+        fmt.srate       = srate;
+        fmt.channels    = channels;
+        fmt.frames      = frames;
+        fmt.format      = mm::SFMT_F32_CPU;
+
+        return os->open(path, &fmt, mm::AFMT_WAV | mm::CFMT_PCM);
+    }
+
+    /**
+     * Get the path to the temporary file which keeps the result of one pass over the input
+     *
+     * @param dst string to store the path
+     * @param cfg configuration
+     * @param pass index of the pass
+     * @return true on success
+     */
+    static bool temp_path(LSPString *dst, const config_t *cfg, size_t pass)
+    {
+        if (!dst->set(&cfg->sOutFile))
+            return false;
+        return (pass > 0) ? dst->fmt_append_ascii(".%d.tmp", int(pass)) : dst->append_ascii(".tmp");
+    }
+
+    /**
+     * Merge the temporary files of all passes into one audio file applying individual gain to each
+     * channel, the destination file is written in the output format specified by the configuration
+     *
+     * @param cfg configuration
+     * @param dst destination file
+     * @param passes number of temporary files, channels of each next file follow the channels of the previous one
+     * @param gains gain for each channel
+     * @param frames size of the block in frames
+     * @param length maximum number of frames to copy
+     * @return status of operation
+     */
+    static status_t rescale_file(const config_t *cfg, const LSPString *dst, size_t passes, const float *gains, size_t frames, size_t length)
+    {
+        status_t res = STATUS_OK;
+        writer_t os;
+        LSPString path;
+
+        mm::InAudioFileStream *vIn = new (std::nothrow) mm::InAudioFileStream[passes];
+        if (vIn == NULL)
+            return STATUS_NO_MEM;
+
+        size_t channels = 0, pass_channels = 0;
+        for (size_t i=0; (res == STATUS_OK) && (i < passes); ++i)
+        {
+            if (!temp_path(&path, cfg, i))
+                res             = STATUS_NO_MEM;
+            else if ((res = vIn[i].open(&path)) == STATUS_OK)
+            {
+                channels       += vIn[i].channels();
+                pass_channels   = lsp_max(pass_channels, vIn[i].channels());
+                length          = lsp_min(length, size_t(vIn[i].length()));
+            }
+        }
+
+        // The only file is read directly to the buffer of the writer, otherwise frames of each file
+        // are read to the separate buffer and interleaved with others
+        uint8_t *pData  = NULL;
+        float *vFrames  = NULL;
+        if ((res == STATUS_OK) && (passes > 1))
+        {
+            vFrames         = alloc_aligned<float>(pData, frames * pass_channels);
+            if (vFrames == NULL)
+                res             = STATUS_NO_MEM;
+        }
+
+        init_writer(&os);
+        if (res == STATUS_OK)
+            res             = open_writer(&os, dst, channels, vIn[0].sample_rate(), length, cfg->nOutFormat, cfg->nOutContainer, frames, NULL);
+
+        // The next block is read and scaled while the previous one is being encoded
+        while ((res == STATUS_OK) && (length > 0))
+        {
+            size_t count    = lsp_min(frames, length);
+            float *buf      = writer_buffer(&os);
+            for (size_t i=0, c=0; i < passes; ++i)
+            {
+                size_t nread    = 0;
+                size_t nch      = vIn[i].channels();
+                float *src      = (passes > 1) ? vFrames : buf;
+                if ((res = read_frames(&vIn[i], src, count, &nread)) != STATUS_OK)
+                    break;
+                if (i == 0)
+                    count           = nread;
+                else if (nread != count)
+                {
+                    res             = STATUS_CORRUPTED;
+                    break;
+                }
+
+                if (passes > 1)
+                {
+                    for (size_t j=0; j<count; ++j)
+                        dsp::copy(&buf[j * channels + c], &src[j * nch], nch);
+                }
+                c              += nch;
+            }
+            if ((res != STATUS_OK) || (count == 0))
+                break;
+            length         -= count;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float *frame = &buf[i * channels];
+                for (size_t j=0; j<channels; ++j)
+                    frame[j]   *= gains[j];
+            }
+
+            res             = writer_submit(&os, count);
+        }
+
+        status_t cres = close_writer(&os);
+        for (size_t i=0; i<passes; ++i)
+            vIn[i].close();
+        delete [] vIn;
+        if (pData != NULL)
+            free_aligned(pData);
+
+        return (res != STATUS_OK) ? res : cres;
+    }
+
+    status_t synth_sweep_file(const config_t *cfg, const LSPString *path, size_t length, size_t repeats)
+    {
+        status_t res;
+        sweep_synth_t synth;
+        mm::OutAudioFileStream os;
+
+        if ((res = init_sweep_synth(&synth, cfg)) != STATUS_OK)
+            return res;
+
+        uint8_t *pData  = NULL;
+        float *vBuffer  = alloc_aligned<float>(pData, SWEEP_FILE_BLOCK_SIZE);
+        if (vBuffer == NULL)
+        {
+            destroy_sweep_synth(&synth);
+            return STATUS_NO_MEM;
+        }
+
+        if ((res = open_output(&os, path, 1, cfg->nSampleRate, wssize_t(length) * repeats)) == STATUS_OK)
+        {
+            for (size_t r = 0; (res == STATUS_OK) && (r < repeats); ++r)
+            {
+                // Each repetition starts the sweep from the beginning
+                if (r > 0)
+                {
+                    destroy_sweep_synth(&synth);
+                    if ((res = init_sweep_synth(&synth, cfg)) != STATUS_OK)
+                        break;
+                }
+
+                // Write the sweep followed by the zero pad
+                for (size_t offset = 0; offset < length; )
+                {
+                    size_t count    = lsp_min(length - offset, size_t(SWEEP_FILE_BLOCK_SIZE));
+                    size_t nsweep   = sweep_synth_process(&synth, vBuffer, count);
+                    dsp::fill_zero(&vBuffer[nsweep], count - nsweep);
+
+                    if ((res = write_frames(&os, vBuffer, 1, count)) != STATUS_OK)
+                        break;
+                    offset         += count;
+                }
+            }
+
+            status_t cres   = os.close();
+            if (res == STATUS_OK)
+                res             = cres;
+        }
+
+        free_aligned(pData);
+        destroy_sweep_synth(&synth);
+
+        return res;
+    }
+
+    status_t load_averaged(const config_t *cfg, const LSPString *path, dspu::Sample *dst, size_t period, size_t repeats)
+    {
+        status_t res;
+        mm::InAudioFileStream is;
+
+        // Open the file, only the header is read at this moment
+        if ((res = is.open(path)) != STATUS_OK)
+            return res;
+        if (is.length() < 0)
+        {
+            is.close();
+            return STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        // Resample the stream by blocks if the sample rate does not match
+        resample_stream_t sResample;
+        resample_stream_t *pResample = NULL;
+        if (ssize_t(is.sample_rate()) != cfg->nSampleRate)
+        {
+            if ((res = init_resample_stream(&sResample, &is, cfg->nSampleRate)) != STATUS_OK)
+            {
+                is.close();
+                return res;
+            }
+            pResample       = &sResample;
+        }
+
+        size_t nChannels    = is.channels();
+        wsize_t nInLength   = (pResample != NULL) ? pResample->nLength : is.length();
+        size_t nLength      = lsp_min(wsize_t(period), nInLength);
+
+        // Allocate the accumulator and the buffer for interleaved frames
+        dspu::Sample avg;
+        uint8_t *pData      = NULL;
+        float *vFrames      = alloc_aligned<float>(pData, SWEEP_FILE_BLOCK_SIZE * nChannels);
+        if ((vFrames == NULL) || (!avg.init(nChannels, nLength, nLength)))
+        {
+            if (pData != NULL)
+                free_aligned(pData);
+            if (pResample != NULL)
+                destroy_resample_stream(pResample);
+            is.close();
+            return STATUS_NO_MEM;
+        }
+        avg.set_sample_rate(cfg->nSampleRate);
+        for (size_t c=0; c<nChannels; ++c)
+            dsp::fill_zero(avg.getBuffer(c), nLength);
+
+        // Sum up all repetitions in one pass over the file
+        wsize_t nTotal      = lsp_min(nInLength, wsize_t(period) * repeats);
+        wsize_t nRead       = 0;
+        while (nRead < nTotal)
+        {
+            size_t offset   = nRead % period;
+            size_t nBlock   = lsp_min(wsize_t(lsp_min(period - offset, size_t(SWEEP_FILE_BLOCK_SIZE))), nTotal - nRead);
+            size_t count    = 0;
+
+            res = (pResample != NULL) ?
+                resample_stream_read(pResample, vFrames, nBlock, &count) :
+                read_frames(&is, vFrames, nBlock, &count);
+            if ((res != STATUS_OK) || (count == 0))
+                break;
+
+            for (size_t c=0; c<nChannels; ++c)
+            {
+                float *buf          = &avg.getBuffer(c)[offset];
+                const float *src    = &vFrames[c];
+                for (size_t i=0; i<count; ++i, src += nChannels)
+                    buf[i]             += *src;
+            }
+
+            nRead          += count;
+        }
+
+        // Each sample is averaged over the number of repetitions which have covered it,
+        // the last repetition may be incomplete
+        if (res == STATUS_OK)
+        {
+            size_t full     = nRead / period;
+            size_t tail     = nRead % period;
+            for (size_t c=0; c<nChannels; ++c)
+            {
+                float *buf          = avg.getBuffer(c);
+                if (tail > 0)
+                    dsp::mul_k2(buf, 1.0f / (full + 1), tail);
+                if (full > 0)
+                    dsp::mul_k2(&buf[tail], 1.0f / full, nLength - tail);
+            }
+            dst->swap(&avg);
+        }
+
+        free_aligned(pData);
+        if (pResample != NULL)
+            destroy_resample_stream(pResample);
+        is.close();
+
+        return res;
+    }
+
+    size_t stream_rank(ssize_t block_size, size_t kernel)
+    {
+        // The default block is bounded, the long kernel is split into more partitions instead
+        size_t block    = (block_size > 0) ? block_size : lsp_min(kernel, size_t(STREAM_BLOCK_SIZE));
+        return fft_rank(lsp_max(block, size_t(1)));
+    }
+
+    wsize_t stream_usage(size_t channels, size_t kernel, size_t rank, size_t pairs)
+    {
+        wsize_t block       = wsize_t(1) << rank;
+        wsize_t fft_size    = block * 2;
+        wsize_t parts       = (kernel + block - 1) / block;
+        wsize_t outputs     = lsp_min(pairs * 2, channels);
+
+        // The reference, the spectra of the kernel partitions, the working buffers, the delay lines of
+        // channel pairs of one pass, the history of channels of one pass and the frames of all channels.
+        // The buffers of the writer of one pass are smaller than the buffers of the final pass which
+        // merges the results of all passes.
+        return kernel + fft_size * (parts * 2 + 4 + parts * pairs * 2) + block * (outputs + channels) +
+               block * (channels * 2 + outputs);
+    }
+
+    size_t stream_pairs(const config_t *cfg, size_t channels, size_t in_length, size_t kernel, size_t rank)
+    {
+        // Without the memory limit, the streaming deconvolution should not take more memory than the
+        // input and the output kept in memory would do
+        size_t pairs        = (channels + 1) >> 1;
+        wsize_t limit       = (cfg->nMaxMemory > 0) ?
+            wsize_t(cfg->nMaxMemory) * 1024 * 1024 / sizeof(float) :
+            wsize_t(channels) * lsp_max(in_length, kernel) * 2;
+
+        size_t count        = pairs;
+        while ((count > 1) && (stream_usage(channels, kernel, rank, count) > limit))
+            --count;
+
+        // Distribute pairs between passes evenly
+        size_t passes       = (pairs + count - 1) / count;
+        return (pairs + passes - 1) / passes;
+    }
+
+    /**
+     * Open the input file for the streaming deconvolution, the input is resampled block by block
+     * if it's sample rate does not match
+     *
+     * @param cfg configuration
+     * @param s state of the streaming deconvolution
+     * @return status of operation
+     */
+    static status_t open_stream_input(const config_t *cfg, stream_t *s)
+    {
+        status_t res;
+        s->pResample        = NULL;
+
+        // Open the input file, only the header is read at this moment
+        if ((res = s->sIn.open(&cfg->sInFile)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not open input audio file: error code=%d\n", int(res));
+            return res;
+        }
+
+        if (s->sIn.length() < 0)
+        {
+            fprintf(stderr, "Could not determine the length of input audio file\n");
+            s->sIn.close();
+            return STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        if (ssize_t(s->sIn.sample_rate()) != cfg->nSampleRate)
+        {
+            if ((res = init_resample_stream(&s->sResample, &s->sIn, cfg->nSampleRate)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not resample input audio file: error code=%d\n", int(res));
+                s->sIn.close();
+                return res;
+            }
+            s->pResample        = &s->sResample;
+        }
+
+        return STATUS_OK;
+    }
+
+    static void close_stream_input(stream_t *s)
+    {
+        if (s->pResample != NULL)
+            destroy_resample_stream(s->pResample);
+        s->pResample        = NULL;
+        s->sIn.close();
+    }
+
+    /**
+     * Build the segment of the channel for the transform: the previous block of the channel
+     * followed by the new one. The new block then becomes the previous one.
+     *
+     * @param s state of the streaming deconvolution
+     * @param dst destination buffer of the transform size
+     * @param history previous block of the channel
+     * @param channel index of the channel in the frames
+     * @param count number of frames read, the rest of the block is padded with zeros
+     */
+    static void fetch_segment(stream_t *s, float *dst, float *history, size_t channel, size_t count)
+    {
+        size_t nBlock       = s->nBlock;
+        float *tail         = &dst[nBlock];
+        const float *src    = &s->vFrames[channel];
+
+        dsp::copy(dst, history, nBlock);
+        for (size_t i=0; i<count; ++i, src += s->nChannels)
+            tail[i]             = *src;
+        dsp::fill_zero(&tail[count], nBlock - count);
+        dsp::copy(history, tail, nBlock);
+    }
+
+    /**
+     * Perform one pass of the streaming deconvolution over the whole input for the group of channels
+     * and store the result to the temporary file
+     *
+     * @param cfg configuration
+     * @param s state of the streaming deconvolution, the input file should be open
+     * @param first first channel of the group
+     * @param channels number of channels in the group
+     * @param path path to the temporary file
+     * @return status of operation
+     */
+    static status_t stream_pass(const config_t *cfg, stream_t *s, size_t first_ch, size_t channels, const LSPString *path)
+    {
+        status_t res;
+        writer_t os;
+        size_t nFftSize     = s->nFftSize;
+        size_t nBlock       = s->nBlock;
+        size_t nParts       = s->nParts;
+        size_t nPairs       = (channels + 1) >> 1;
+
+        dsp::fill_zero(s->vHistory, nBlock * channels);
+        dsp::fill_zero(s->vDelayRe, nFftSize * nParts * nPairs);
+        dsp::fill_zero(s->vDelayIm, nFftSize * nParts * nPairs);
+
+        // The temporary file keeps floating-point samples, it should be RF64 if the output can exceed 4 GB
+        init_writer(&os);
+        res = open_writer(&os, path, channels, cfg->nSampleRate, s->nOutLength, SAMPLE_F32,
+            (cfg->nOutContainer == CONTAINER_RF64) ? CONTAINER_RF64 : CONTAINER_WAV, nBlock, NULL);
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "Could not create temporary output audio file: error code=%d\n", int(res));
+            return res;
+        }
+
+        // Process the input block by block, the spectrum of the newest segment is stored at the head
+        // of the delay line and the older ones follow it cyclically
+        bool eof            = false;
+        for (size_t offset = 0, head = 0; offset < s->nResult; offset += nBlock, head = (head + 1) % nParts)
+        {
+            // Read the next block, after the end of file the input is padded with zeros
+            size_t count        = 0;
+            if (!eof)
+            {
+                res                 = (s->pResample != NULL) ?
+                    resample_stream_read(s->pResample, s->vFrames, nBlock, &count) :
+                    read_frames(&s->sIn, s->vFrames, nBlock, &count);
+                if (res != STATUS_OK)
+                {
+                    fprintf(stderr, "Could not read input audio file: error code=%d\n", int(res));
+                    break;
+                }
+                eof                 = count < nBlock;
+            }
+
+            // Compute the range of the result to be written to the output file
+            size_t first        = lsp_max(offset, s->nOrigin);
+            size_t last         = lsp_min(offset + nBlock, s->nOrigin + s->nOutLength);
+            size_t nwrite       = (first < last) ? last - first : 0;
+
+            // Process channels by pairs, see deconvolve() for details. The result is interleaved
+            // into the buffer of the writer while the previous block is being written.
+            float *vOut         = writer_buffer(&os);
+            for (size_t c = 0; c < channels; c += 2)
+            {
+                size_t nPair        = lsp_min(channels - c, size_t(2));
+                float *vLineRe      = &s->vDelayRe[(c >> 1) * nParts * nFftSize];
+                float *vLineIm      = &s->vDelayIm[(c >> 1) * nParts * nFftSize];
+
+                // Put the spectrum of the new segment to the delay line
+                fetch_segment(s, s->vRe, &s->vHistory[c * nBlock], first_ch + c, count);
+                if (nPair > 1)
+                    fetch_segment(s, s->vIm, &s->vHistory[(c + 1) * nBlock], first_ch + c + 1, count);
+                else
+                    dsp::fill_zero(s->vIm, nFftSize);
+                dsp::direct_fft(&vLineRe[head * nFftSize], &vLineIm[head * nFftSize], s->vRe, s->vIm, s->nRank);
+
+                // Accumulate products of the delayed segments with the kernel partitions
+                for (size_t p = 0, d = head; p < nParts; ++p, d = (d > 0) ? d - 1 : nParts - 1)
+                {
+                    float *dre          = (p > 0) ? s->vRe : s->vAccRe;
+                    float *dim          = (p > 0) ? s->vIm : s->vAccIm;
+                    dsp::complex_mul3(dre, dim, &vLineRe[d * nFftSize], &vLineIm[d * nFftSize],
+                        &s->vKernelRe[p * nFftSize], &s->vKernelIm[p * nFftSize], nFftSize);
+                    if (p <= 0)
+                        continue;
+                    dsp::add2(s->vAccRe, s->vRe, nFftSize);
+                    dsp::add2(s->vAccIm, s->vIm, nFftSize);
+                }
+                dsp::reverse_fft(s->vRe, s->vIm, s->vAccRe, s->vAccIm, s->nRank);
+
+                for (size_t i = 0; i < nPair; ++i)
+                {
+                    // The first half is affected by circular convolution, skip it
+                    size_t ch           = first_ch + c + i;
+                    const float *vResult = ((i == 0) ? s->vRe : s->vIm) + nBlock;
+                    s->vPeak[ch]        = lsp_max(s->vPeak[ch], dsp::abs_max(vResult, nBlock));
+                    if (nwrite == 0)
+                        continue;
+
+                    const float *src    = &vResult[first - offset];
+                    s->vWinPeak[ch]     = lsp_max(s->vWinPeak[ch], dsp::abs_max(src, nwrite));
+
+                    // Accumulate energies of the output blocks
+                    float *e            = &s->vEnergy[ch * s->nIRBlocks];
+                    for (size_t j=0, o=first - s->nOrigin; (j < nwrite) && (s->nIRBlocks > 0); )
+                    {
+                        size_t k            = lsp_min(nwrite - j, s->nIRBlock - o % s->nIRBlock);
+                        e[o / s->nIRBlock] += dsp::h_sqr_sum(&src[j], k);
+                        j                  += k;
+                        o                  += k;
+                    }
+
+                    float *dst          = &vOut[c + i];
+                    for (size_t j=0; j<nwrite; ++j, dst += channels)
+                        *dst                = src[j];
+                }
+            }
+
+            if (nwrite == 0)
+                continue;
+
+            if ((res = writer_submit(&os, nwrite)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not write temporary output audio file: error code=%d\n", int(res));
+                break;
+            }
+        }
+
+        status_t cres = close_writer(&os);
+        return (res != STATUS_OK) ? res : cres;
+    }
+
+    status_t deconvolve_stream(const config_t *cfg, const dspu::Sample &ref, float norm_gain, arena_t *arena)
+    {
+        status_t res;
+        stream_t s;
+
+        // We expect the reference to be mono.
+        if (ref.channels() != 1)
+            return STATUS_FAILED;
+
+        if ((res = open_stream_input(cfg, &s)) != STATUS_OK)
+            return res;
+
+        // Keep the same geometry of the result as the in-memory deconvolution does
+        size_t nChannels    = s.sIn.channels();
+        size_t nInLength    = (s.pResample != NULL) ? s.pResample->nLength : s.sIn.length();
+        size_t nRefLength   = ref.length();
+        s.nChannels         = nChannels;
+        s.nOutLength        = lsp_max(nInLength, nRefLength);
+        s.nOrigin           = s.nOutLength - 1;
+
+        // The kernel is the reference backwards in time. Trailing zeros of the reference (usually the
+        // zero pad of the generated test signal) do not contribute to the result, so trim them and
+        // shift the origin of time by the same number of samples.
+        const float *vRef   = ref.getBuffer(0);
+        size_t nKernel      = nRefLength;
+        while ((nKernel > 1) && (vRef[nKernel - 1] == 0.0f))
+            --nKernel;
+        s.nOrigin          -= nRefLength - nKernel;
+
+        // Overall number of samples in the result that should be computed to get the peak value
+        // and all samples that should be written to the output file.
+        s.nResult           = lsp_max(nInLength + nKernel - 1, s.nOrigin + s.nOutLength);
+
+        // Uniformly partitioned overlap-save parameters: the kernel is split into nParts partitions
+        // of nBlock samples. Each transform consumes the previous and the new block of the input, so
+        // the size of transforms depends only on the block size. The spectra of the last nParts
+        // segments are kept in the frequency-domain delay line, and each block of the result is the
+        // sum of their products with the spectra of the kernel partitions. The delay lines take memory
+        // proportional to the kernel length for each pair of channels, so if they do not fit into the
+        // memory limit, the input is read several times and each pass deconvolves the group of pairs.
+        size_t nBlockRank   = stream_rank(cfg->nBlockSize, nKernel);
+        size_t nPassPairs   = stream_pairs(cfg, nChannels, nInLength, nKernel, nBlockRank);
+        size_t nPairs       = (nChannels + 1) >> 1;
+        size_t nPasses      = (nPairs + nPassPairs - 1) / nPassPairs;
+        size_t nPassCh      = lsp_min(nPassPairs * 2, nChannels);
+        s.nRank             = nBlockRank + 1;
+        s.nFftSize          = size_t(1) << s.nRank;
+        s.nBlock            = s.nFftSize >> 1;
+        s.nParts            = (nKernel + s.nBlock - 1) / s.nBlock;
+        size_t nFftSize     = s.nFftSize;
+        size_t nParts       = s.nParts;
+
+        lsp_debug("streaming deconvolution: channels=%d, fft size=%d, block size=%d, partitions=%d, passes=%d",
+            int(nChannels), int(nFftSize), int(s.nBlock), int(nParts), int(nPasses));
+
+        // Allocate buffers:
+        // 2X Spectra of the kernel partitions (real and imaginary parts), of size nFftSize * nParts
+        // 4X Working buffer and accumulator (real and imaginary parts), of size nFftSize
+        // 2X Delay line of the segment spectra of each pair of channels of one pass, of size nFftSize * nParts * nPassPairs
+        // nPassCh X Previous block of each channel of one pass, of size nBlock
+        // 1X Interleaved frame buffer, of size nBlock * nChannels
+        // 3X Per-channel peak values and gains, of size nChannels
+        // nChannels X Energies of the output blocks for the impulse response truncation, if enabled
+        s.nIRBlock          = ir_block_size(cfg);
+        s.nIRBlocks         = (cfg->bIRAuto) ? (s.nOutLength + s.nIRBlock - 1) / s.nIRBlock : 0;
+        // The buffers are taken from the arena if it is specified, the arena kept between jobs of
+        // the server is reallocated only if it is too small.
+        uint8_t *pData      = NULL;
+        size_t nTotal       = nFftSize * (nParts * 2 + 4 + nParts * nPassPairs * 2) +
+                              s.nBlock * (nPassCh + nChannels) + nChannels * 3 + s.nIRBlocks * nChannels;
+
+        size_t nMark        = (arena != NULL) ? arena->nUsed : 0;
+        if ((arena != NULL) && (nMark <= 0))
+            reserve_arena(arena, arena_size<float>(nTotal));
+        float *ptr          = (arena != NULL) ? arena_alloc<float>(arena, nTotal) : NULL;
+        if ((ptr == NULL) && ((ptr = alloc_aligned<float>(pData, nTotal)) == NULL))
+        {
+            close_stream_input(&s);
+            return STATUS_NO_MEM;
+        }
+
+        lsp_guard_assert(float *save = ptr);
+
+        s.vKernelRe         = ptr;
+        ptr                += nFftSize * nParts;
+        s.vKernelIm         = ptr;
+        ptr                += nFftSize * nParts;
+        s.vRe               = ptr;
+        ptr                += nFftSize;
+        s.vIm               = ptr;
+        ptr                += nFftSize;
+        s.vAccRe            = ptr;
+        ptr                += nFftSize;
+        s.vAccIm            = ptr;
+        ptr                += nFftSize;
+        s.vDelayRe          = ptr;
+        ptr                += nFftSize * nParts * nPassPairs;
+        s.vDelayIm          = ptr;
+        ptr                += nFftSize * nParts * nPassPairs;
+        s.vHistory          = ptr;
+        ptr                += s.nBlock * nPassCh;
+        s.vFrames           = ptr;
+        ptr                += s.nBlock * nChannels;
+        s.vPeak             = ptr;          // Peak of the whole result
+        ptr                += nChannels;
+        s.vWinPeak          = ptr;          // Peak of the part written to the output file
+        ptr                += nChannels;
+        s.vGain             = ptr;
+        ptr                += nChannels;
+        s.vEnergy           = ptr;
+        ptr                += s.nIRBlocks * nChannels;
+
+        lsp_assert(ptr <= &save[nTotal]);
+
+        dsp::fill_zero(s.vPeak, nChannels);
+        dsp::fill_zero(s.vWinPeak, nChannels);
+        dsp::fill_zero(s.vEnergy, s.nIRBlocks * nChannels);
+
+        // Compute the spectra of the kernel partitions, the second half of each partition is zero
+        for (size_t p = 0; p < nParts; ++p)
+        {
+            float *re           = &s.vKernelRe[p * nFftSize];
+            float *im           = &s.vKernelIm[p * nFftSize];
+            size_t count        = lsp_min(nKernel - p * s.nBlock, s.nBlock);
+            dsp::fill_zero(re, nFftSize);
+            dsp::fill_zero(im, nFftSize);
+            dsp::reverse2(re, &vRef[nKernel - p * s.nBlock - count], count);
+            dsp::direct_fft(re, im, re, im, s.nRank);
+        }
+
+        // The result is not normalized yet, so store the result of each pass into the temporary file first
+        LSPString tmp;
+        size_t nDone        = 0;
+        for (size_t pass = 0; pass < nPasses; ++pass)
+        {
+            // Each next pass reads the input from the beginning
+            if ((pass > 0) && ((res = open_stream_input(cfg, &s)) != STATUS_OK))
+                break;
+
+            size_t first        = pass * nPassCh;
+            if (!temp_path(&tmp, cfg, pass))
+                res                 = STATUS_NO_MEM;
+            else
+            {
+                ++nDone;
+                res                 = stream_pass(cfg, &s, first, lsp_min(nChannels - first, nPassCh), &tmp);
+            }
+            close_stream_input(&s);
+            if (res != STATUS_OK)
+                break;
+        }
+
+        // Normalize each channel like dsp::normalize() does, then apply the output normalization
+        if (res == STATUS_OK)
+        {
+            float peak      = 0.0f;
+            for (size_t c = 0; c < nChannels; ++c)
+            {
+                s.vGain[c]      = (s.vPeak[c] > 0.0f) ? 1.0f / s.vPeak[c] : 1.0f;
+                peak            = lsp_max(peak, s.vWinPeak[c] * s.vGain[c]);
+            }
+            dsp::mul_k2(s.vGain, normalizing_gain(peak, norm_gain, cfg->nNormalize), nChannels);
+
+            // Truncate the impulse response
+            size_t keep     = ir_length(cfg, s.vEnergy, nChannels, s.nOutLength);
+
+            if ((res = rescale_file(cfg, &cfg->sOutFile, nPasses, s.vGain, s.nBlock, keep)) != STATUS_OK)
+                fprintf(stderr, "Could not write output audio file: error code=%d\n", int(res));
+        }
+
+        // Clean allocated resources.
+        for (size_t pass = 0; pass < nDone; ++pass)
+        {
+            if (temp_path(&tmp, cfg, pass))
+                remove(tmp.get_native());
+        }
+        if (pData != NULL)
+            free_aligned(pData);
+        else
+            rewind_arena(arena, nMark);
+
+        return res;
+    }
+}
@@ -22,13 +22,25 @@
 #include <lsp-plug.in/common/status.h>
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 #include <private/tool.h>
 #include <private/config.h>
 #include <private/cmdline.h>
 #include <private/dsp.h>
+#include <private/plan.h>
+#include <private/resample.h>
+#include <private/batch.h>
+#include <private/stream.h>
+#include <private/stats.h>
+#include <private/writer.h>
+#include <private/cache.h>
+#include <private/serve.h>
+
+#include <new>
 
 #define MIN_SAMPLE_RATE         8000
 #define MAX_SAMPLE_RATE         192000
@@ -39,10 +51,27 @@ namespace room_raider
 {
     using namespace lsp;
 
-    status_t generate_sweep(config_t *cfg)
+    static status_t harmonic_file_name(LSPString *dst, const LSPString *path, size_t order)
+    {
+        // Insert the suffix with the harmonic order before the file extension
+        ssize_t dot     = path->rindex_of('.');
+        ssize_t sep     = path->rindex_of(FILE_SEPARATOR_C);
+        if (dot <= sep)
+            dot             = path->length();
+
+        if (!dst->set(path, 0, dot))
+            return STATUS_NO_MEM;
+        if (!dst->fmt_append_ascii("-h%d", int(order)))
+            return STATUS_NO_MEM;
+        if (!dst->append(path, dot))
+            return STATUS_NO_MEM;
+
+        return STATUS_OK;
+    }
+
+    status_t generate_sweep(config_t *cfg, stats_t *stats)
     {
         status_t res;
-        dspu::Sample out;       // Sample for output
 
         // Initial frequency, Hz, smaller than sample_rate/2
         if ((cfg->fStartFreq*2.0f) >= cfg->nSampleRate)
@@ -73,42 +102,355 @@ namespace room_raider
 //        // Amplitude: as you wish but we can pin it to 1
 //        float cgain     = dspu::db_to_gain(cfg->fGain);
 
-        // Initialize output sample
         // Using 2X sweep length, sweep itself should be longer than expected reverberation time to be on the safe side.
         // The time is provided in ms
         lsp_debug("sample rate: %d, seep length: %f", int(cfg->nSampleRate), cfg->fSweepLength);
-        size_t length = dspu::millis_to_samples(cfg->nSampleRate, 2.0f * cfg->fSweepLength);
-        if (!out.init(1, length, length))
+        size_t length = sweep_period(cfg);
+        usage_t usage;
+        stage_begin(stats, &usage);
+
+        // Sync chirp + sine sweep generation - At the moment swept sine only as chirp is not needed:
+        // new deconvolution technique automatically discards latency thanks to reference signal.
+        // The sweep is synthesized and written to the output file by blocks, repetitions follow each other.
+        if ((res = synth_sweep_file(cfg, &cfg->sOutFile, length, cfg->nRepeats)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not synthesize test sweep: error code=%d\n", int(res));
+            return res;
+        }
+        stage_end(stats, &usage, "synthesize", 1, 0, file_size(&cfg->sOutFile));
+
+        // Save the inverse filter: the time-reversed sweep with the compensating envelope
+        if (!cfg->sInverse.is_empty())
+        {
+            stage_begin(stats, &usage);
+            dspu::Sample inv;
+            size_t nSweep = lsp_min(size_t(dspu::millis_to_samples(cfg->nSampleRate, cfg->fSweepLength)), length);
+            if (!inv.init(1, nSweep, nSweep))
+            {
+                fprintf(stderr, "Could not initialize inverse filter sample\n");
+                return STATUS_NO_MEM;
+            }
+            inv.set_sample_rate(cfg->nSampleRate);
+
+            if ((res = synth_test_sweep(cfg, inv)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not synthesize inverse filter: error code=%d\n", int(res));
+                return res;
+            }
+            apply_sweep_envelope(cfg, &inv);
+            dsp::reverse1(inv.getBuffer(0), nSweep);
+            dsp::normalize(inv.getBuffer(0), inv.getBuffer(0), nSweep);
+
+            if (inv.save(&cfg->sInverse) < 0)
+            {
+                fprintf(stderr, "Could not write inverse filter audio file\n");
+                return STATUS_IO_ERROR;
+            }
+            stage_end(stats, &usage, "inverse", 1, 0, file_size(&cfg->sInverse));
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t load_reference(const config_t *cfg, const LSPString *path, dspu::Sample *ref, stats_t *stats, size_t threads)
+    {
+        status_t res;
+        usage_t usage;          // Resource usage at the start of the stage
+
+        // Read the reference file, repetitions of the test signal are averaged while reading
+        stage_begin(stats, &usage);
+        if (cfg->nRepeats > 1)
+        {
+            if ((res = load_averaged(cfg, path, ref, sweep_period(cfg), cfg->nRepeats)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not read and average reference audio file: error code=%d\n", int(res));
+                return res;
+            }
+            stage_end(stats, &usage, "load_reference", ref->channels(), file_size(path), 0);
+        }
+        else
+        {
+            if ((res = ref->load(path)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not read reference audio file: error code=%d\n", int(res));
+                return res;
+            }
+            stage_end(stats, &usage, "load_reference", ref->channels(), file_size(path), 0);
+
+            // Resample reference file to desired sample rate
+            stage_begin(stats, &usage);
+            if ((res = resample(ref, cfg->nSampleRate, threads)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not resample reference audio file content: error code=%d\n", int(res));
+                return res;
+            }
+            stage_end(stats, &usage, "resample_reference", ref->channels(), 0, 0);
+        }
+
+        // Apply the envelope of the inverse filter, the regularized inverse filter equalizes the spectrum itself
+        if (!cfg->bRegularize)
+            apply_sweep_envelope(cfg, ref);
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Deconvolve the input file by blocks in the streaming mode
+     */
+    static status_t stream_reference(config_t *cfg, stats_t *stats, const dspu::Sample &ref, arena_t *arena)
+    {
+        status_t res;
+        usage_t usage;          // Resource usage at the start of the stage
+
+        if (ref.channels() != 1)
+        {
+            fprintf(stderr, "Streaming mode requires mono reference audio file\n");
+            return STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        float norm_gain = (cfg->fNormGain >= MIN_GAIN) ? dspu::db_to_gain(cfg->fNormGain) : 0.0f;
+
+        stage_begin(stats, &usage);
+        if ((res = deconvolve_stream(cfg, ref, norm_gain, arena)) != STATUS_OK)
+            return res;
+        stage_end(stats, &usage, "stream", 0, file_size(&cfg->sInFile), file_size(&cfg->sOutFile));
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Read the input file, the synchronous averaging of repetitions keeps only one period in memory.
+     * Uncompressed files with matching sample rate are mapped into memory and not decoded at all,
+     * the system reads them ahead in the background.
+     */
+    static status_t load_input(config_t *cfg, stats_t *stats, dspu::Sample *in, mapped_wav_t *mapped, size_t threads)
+    {
+        status_t res;
+        usage_t usage;          // Resource usage at the start of the stage
+
+        stage_begin(stats, &usage);
+        if ((cfg->nRepeats <= 1) && (open_mapped_wav(mapped, &cfg->sInFile) == STATUS_OK))
+        {
+            if (ssize_t(mapped->nSampleRate) != cfg->nSampleRate)
+                close_mapped_wav(mapped);
+        }
+
+        if (mapped->pMap != NULL)
         {
-            fprintf(stderr, "Could not initialize output sample\n");
+            prefetch_mapped_wav(mapped);
+            stage_end(stats, &usage, "map_input", mapped->nChannels, 0, 0);
+        }
+        else if (cfg->nRepeats > 1)
+        {
+            if ((res = load_averaged(cfg, &cfg->sInFile, in, sweep_period(cfg), cfg->nRepeats)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not read and average input audio file: error code=%d\n", int(res));
+                return res;
+            }
+            stage_end(stats, &usage, "load_input", in->channels(), file_size(&cfg->sInFile), 0);
+        }
+        else
+        {
+            if ((res = in->load(&cfg->sInFile)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not read input audio file: error code=%d\n", int(res));
+                return res;
+            }
+            stage_end(stats, &usage, "load_input", in->channels(), file_size(&cfg->sInFile), 0);
+
+            // Resample input file to desired sample rate
+            stage_begin(stats, &usage);
+            if ((res = resample(in, cfg->nSampleRate, threads)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not resample input audio file content: error code=%d\n", int(res));
+                return res;
+            }
+            stage_end(stats, &usage, "resample_input", in->channels(), 0, 0);
+        }
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Deconvolve the input with the reference, then normalize, truncate and save the result
+     */
+    static status_t deconvolve_input(config_t *cfg, stats_t *stats, const dspu::Sample &ref, const dspu::Sample &in,
+        mapped_wav_t *mapped, kernel_store_t *store, arena_t *arena)
+    {
+        status_t res;
+        usage_t usage;          // Resource usage at the start of the stage
+        dspu::Sample out;       // Sample for output
+
+        // Compute normalization gain
+        float norm_gain = (cfg->fNormGain >= MIN_GAIN) ? dspu::db_to_gain(cfg->fNormGain) : 0.0f;
+
+        size_t nInChannels  = (mapped->pMap != NULL) ? mapped->nChannels : in.channels();
+        size_t nInLength    = (mapped->pMap != NULL) ? size_t(mapped->nFrames) : in.length();
+
+        // Initialize output sample
+        // We keep the output (Impulse Response) length the same as the longest recording
+        // unless only the window of it is requested.
+        size_t length   = lsp_max(nInLength, ref.length());
+        size_t first    = 0;
+        ir_window(cfg, &first, &length);
+
+        // The harmonic distortion IRs of the exponential sweep are placed before the linear IR,
+        // so we keep some negative time before the origin. Each harmonic gets the same pre-delay.
+        size_t lead = 0, pre = harmonic_predelay(cfg);
+        if (cfg->nHarmonics > 0)
+            lead    = lsp_min(harmonic_offset(cfg, cfg->nHarmonics) + pre, length - 1);
+
+        // Each route of the reference channel to the input channel produces one output channel
+        lltl::darray<route_t> routes;
+        if ((res = build_routes(cfg, nInChannels, ref.channels(), &routes)) != STATUS_OK)
+        {
+            close_mapped_wav(mapped);
+            return res;
+        }
+
+        if (!out.init(routes.size(), length + lead, length + lead))
+        {
+            close_mapped_wav(mapped);
+            fprintf(stderr, "Could not initialize outut sample\n");
             return STATUS_UNSPECIFIED;
         }
         out.set_sample_rate(cfg->nSampleRate); // This sample rate will be written to output file
 
-        // Sync chirp + sine sweep generation - At the moment swept sine only as chirp is not needed:
-        // new deconvolution technique automatically discards latency thanks to reference signal.
-        if ((res = synth_test_sweep(cfg, out)) != STATUS_OK)
+        // Reserve the memory for the stage with the largest footprint, stages take it from the arena
+        // one after another. The arena kept between jobs is reallocated only if it is too small.
+        size_t footprint = lsp_max(
+            lsp_max(deconv_arena_size(cfg, nInChannels, nInLength, ref.channels(), ref.length(), store != NULL),
+                ir_length_arena_size(cfg, out.channels(), length)),
+            writer_arena_size(out.channels()));
+        if ((arena != NULL) && ((res = reserve_arena(arena, footprint)) != STATUS_OK))
         {
-            fprintf(stderr, "Could not synthesize test sweep: error code=%d\n", int(res));
+            close_mapped_wav(mapped);
+            fprintf(stderr, "Could not reserve memory: error code=%d\n", int(res));
             return res;
         }
 
+        // The latency is estimated from the deconvolution result of each output channel
+        lltl::darray<latency_t> latency;
+        for (size_t i=0; (cfg->bLatency) && (i < routes.size()); ++i)
+        {
+            if (latency.add() == NULL)
+            {
+                close_mapped_wav(mapped);
+                return STATUS_NO_MEM;
+            }
+        }
+
+        // deconvolution
+        stage_begin(stats, &usage);
+        latency_t *vLatency = (cfg->bLatency) ? latency.array() : NULL;
+        res = (mapped->pMap != NULL) ?
+            deconvolve(cfg, mapped, ref, out, lead, vLatency, store, arena) :
+            deconvolve(cfg, in, ref, out, lead, vLatency, store, arena);
+        close_mapped_wav(mapped);
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "Could not deconvolve input audio file: error code=%d\n", int(res));
+            return res;
+        }
+        stage_end(stats, &usage, "deconvolve", out.channels(), (in.channels() > 0) ? 0 : file_size(&cfg->sInFile), 0);
+
+        if ((vLatency != NULL) && ((res = write_latency(cfg, routes.array(), vLatency, routes.size())) != STATUS_OK))
+        {
+            fprintf(stderr, "Could not write latency report: error code=%d\n", int(res));
+            return res;
+        }
+
+        // normalization
+        stage_begin(stats, &usage);
+        normalize(&out, norm_gain, cfg->nNormalize);
+        stage_end(stats, &usage, "normalize", out.channels(), 0, 0);
+
+        // Truncate the impulse response
+        size_t keep = length;
+        stage_begin(stats, &usage);
+        if ((res = estimate_ir_length(cfg, out, lead, length, &keep, arena)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not estimate the length of impulse response: error code=%d\n", int(res));
+            return res;
+        }
+        stage_end(stats, &usage, "truncate", out.channels(), 0, 0);
+
         // Save the sample to output
-        if (out.save(&cfg->sOutFile) < 0)
+        stage_begin(stats, &usage);
+        if ((res = save_window(cfg, out, lead, keep, &cfg->sOutFile, arena)) != STATUS_OK)
         {
             fprintf(stderr, "Could not write output audio file\n");
-            return STATUS_IO_ERROR;
+            return res;
+        }
+        wsize_t written = file_size(&cfg->sOutFile);
+        if (lead <= 0)
+        {
+            stage_end(stats, &usage, "save", out.channels(), 0, written);
+            return STATUS_OK;
+        }
+
+        // Save harmonic distortion IRs, each one lasts until the start of the previous harmonic
+        LSPString path;
+        for (ssize_t k=2; k <= cfg->nHarmonics; ++k)
+        {
+            size_t offset   = harmonic_offset(cfg, k) + pre;
+            if (offset > lead)
+            {
+                fprintf(stderr, "Harmonic %d does not fit into the recording, skipping\n", int(k));
+                continue;
+            }
+
+            if ((res = harmonic_file_name(&path, &cfg->sOutFile, k)) != STATUS_OK)
+                return res;
+            if ((res = save_window(cfg, out, lead - offset, harmonic_offset(cfg, k) - harmonic_offset(cfg, k - 1), &path, arena)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not write harmonic %d output audio file\n", int(k));
+                return res;
+            }
+            written        += file_size(&path);
         }
+        stage_end(stats, &usage, "save", out.channels(), 0, written);
 
         return STATUS_OK;
     }
 
-    status_t deconvolve(config_t *cfg)
+    /**
+     * Reference which is read by the background thread while the input is being read
+     */
+    typedef struct ref_job_t
+    {
+        config_t               *pConfig;        // Configuration
+        stats_t                *pStats;         // Statistics
+        ref_cache_t            *pCache;         // Cache of the server, NULL if not used
+        ref_entry_t            *pEntry;         // Reference acquired from the cache
+        dspu::Sample            sSample;        // Reference read without the cache
+        size_t                  nThreads;       // Maximum number of threads to resample the reference
+        status_t                nStatus;        // Status of operation
+    } ref_job_t;
+
+    static status_t load_reference_job(ref_job_t *j)
+    {
+        j->nStatus      = (j->pCache != NULL) ?
+            acquire_reference(j->pCache, j->pConfig, &j->pConfig->sReference, j->pStats, j->nThreads, &j->pEntry) :
+            load_reference(j->pConfig, &j->pConfig->sReference, &j->sSample, j->pStats, j->nThreads);
+        return j->nStatus;
+    }
+
+    static status_t reference_job(void *arg)
+    {
+        // Each additional thread should initialize DSP context
+        dsp::context_t ctx;
+        dsp::start(&ctx);
+
+        status_t res    = load_reference_job(static_cast<ref_job_t *>(arg));
+
+        dsp::finish(&ctx);
+        return res;
+    }
+
+    status_t deconvolve(config_t *cfg, stats_t *stats, ref_cache_t *cache, arena_t *arena)
     {
         status_t res;
-        dspu::Sample in;        // Sample for input
-        dspu::Sample out;       // Sample for output
-        dspu::Sample ref;       // Sample for reference
 
         // Check that input file name is present
         if (cfg->sInFile.is_empty())
@@ -124,98 +466,336 @@ namespace room_raider
             return STATUS_INVALID_VALUE;
         }
 
-        // Read the input file
-        if ((res = in.load(&cfg->sInFile)) != STATUS_OK)
+        // Select the execution strategy which fits into the memory limit
+        if (cfg->nMaxMemory > 0)
         {
-            fprintf(stderr, "Could not read input audio file: error code=%d\n", int(res));
-            return res;
+            plan_t plan;
+            if ((res = plan_deconvolution(cfg, &plan)) != STATUS_OK)
+                return res;
+
+            // The standard output is left for the reports
+            fprintf(stderr, "Estimated peak memory usage: %.1f MB, strategy: %s, threads: %d",
+                double(plan.nMemory) / (1024.0 * 1024.0), strategy_name(plan.enStrategy), int(plan.nThreads));
+            if (plan.enStrategy == STRATEGY_CHUNKED)
+                fprintf(stderr, ", block size: %d", int(plan.nBlockSize));
+            fprintf(stderr, "\n");
+
+            apply_plan(cfg, &plan);
         }
 
-        // Resample input file to desired sample rate
-        if ((res = in.resample(cfg->nSampleRate)) != STATUS_OK)
+        // Read the reference file or take it from the cache of the server, the cached reference
+        // also keeps it's spectra between jobs
+        ref_job_t job;
+        job.pConfig     = cfg;
+        job.pStats      = stats;
+        job.pCache      = cache;
+        job.pEntry      = NULL;
+        job.nThreads    = select_threads(cfg, size_t(-1));
+        job.nStatus     = STATUS_OK;
+
+        // The streaming deconvolution reads the input by itself, so the reference is read first
+        if (cfg->bStream)
         {
-            fprintf(stderr, "Could not resample input audio file content: error code=%d\n", int(res));
+            if ((res = load_reference_job(&job)) == STATUS_OK)
+                res             = stream_reference(cfg, stats, (job.pEntry != NULL) ? job.pEntry->sSample : job.sSample, arena);
+            if (job.pEntry != NULL)
+                release_reference(cache, job.pEntry);
             return res;
         }
 
-        // Read the reference file
-        if ((res = ref.load(&cfg->sReference)) != STATUS_OK)
+        // Otherwise the reference is read by the background thread while the input is read, decoded and
+        // resampled by the calling thread. The mapped input is read ahead by the system meanwhile, so the
+        // deconvolution starts as soon as the reference is ready. The threads for resampling are split
+        // between both loaders while they run at the same time. If the thread can not be started,
+        // the reference is read after the input with all threads.
+        size_t threads      = job.nThreads;
+        job.nThreads        = lsp_max(threads / 2, size_t(1));
+        ipc::Thread *thread = new (std::nothrow) ipc::Thread(reference_job, &job);
+        if ((thread != NULL) && (thread->start() != STATUS_OK))
         {
-            fprintf(stderr, "Could not read reference audio file: error code=%d\n", int(res));
-            return res;
+            delete thread;
+            thread          = NULL;
         }
 
-        // Resample reference file to desired sample rate
-        if ((res = ref.resample(cfg->nSampleRate)) != STATUS_OK)
+        dspu::Sample in;        // Sample for input
+        mapped_wav_t mapped;    // Memory-mapped input file
+        init_mapped_wav(&mapped);
+        res = load_input(cfg, stats, &in, &mapped,
+            (thread != NULL) ? lsp_max(threads - job.nThreads, size_t(1)) : threads);
+
+        if (thread != NULL)
         {
-            fprintf(stderr, "Could not resample reference audio file content: error code=%d\n", int(res));
-            return res;
+            thread->join();
+            delete thread;
+        }
+        else if (res == STATUS_OK)
+        {
+            job.nThreads        = threads;
+            load_reference_job(&job);
         }
 
-        // Initialize output sample
-        // We keep the output (Impulse Response) length the same as the longest recording.
-        size_t length   = lsp_max(in.length(), ref.length());
-        if (!out.init(in.channels(), length, length))
+        if ((res == STATUS_OK) && ((res = job.nStatus) == STATUS_OK))
         {
-            fprintf(stderr, "Could not initialize outut sample\n");
-            return STATUS_UNSPECIFIED;
+            res = (job.pEntry != NULL) ?
+                deconvolve_input(cfg, stats, job.pEntry->sSample, in, &mapped, &job.pEntry->sKernels, arena) :
+                deconvolve_input(cfg, stats, job.sSample, in, &mapped, NULL, arena);
         }
-        out.set_sample_rate(cfg->nSampleRate); // This sample rate will be written to output file
 
-        // deconvolution
-        deconvolve(cfg, in, ref, out);
+        close_mapped_wav(&mapped);
+        if (job.pEntry != NULL)
+            release_reference(cache, job.pEntry);
 
-        // normalization
+        return res;
+    }
+
+    status_t batch(config_t *cfg, stats_t *stats)
+    {
+        // Compute normalization gain
         float norm_gain = (cfg->fNormGain >= MIN_GAIN) ? dspu::db_to_gain(cfg->fNormGain) : 0.0f;
-        normalize(&out, norm_gain, cfg->nNormalize);
 
-        // Save the sample to output
-        if (out.save(&cfg->sOutFile) < 0)
-        {
-            fprintf(stderr, "Could not write output audio file\n");
-            return STATUS_IO_ERROR;
-        }
+        usage_t usage;
+        stage_begin(stats, &usage);
+        status_t res = deconvolve_batch(cfg, stats, norm_gain);
+        if (res == STATUS_OK)
+            stage_end(stats, &usage, "batch", 0, 0, 0);
 
-        return STATUS_OK;
+        return res;
     }
 
-    int main(int argc, const char **argv)
+    status_t process(config_t *cfg, stats_t *stats, ref_cache_t *cache, arena_t *arena)
     {
-        config_t cfg;
+        if (cfg->enMode == M_SWEEP)
+            return generate_sweep(cfg, stats);
+        else if (cfg->enMode == M_DECONVOLVE)
+            return deconvolve(cfg, stats, cache, arena);
+        else if (cfg->enMode == M_BATCH)
+            return batch(cfg, stats);
+
+        return STATUS_BAD_ARGUMENTS;
+    }
 
-        // Parse command line
-        status_t res = parse_cmdline(&cfg, argc, argv);
+    status_t run(config_t *cfg)
+    {
+        stats_t stats;
+        init_stats(&stats, cfg);
+
+        arena_t arena;
+        init_arena(&arena, cfg->bHugePages);
+        status_t res = process(cfg, &stats, NULL, &arena);
+        destroy_arena(&arena);
         if (res != STATUS_OK)
             return res;
 
+        // Output processing statistics
+        if ((res = write_stats(&stats, cfg)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not write statistics: error code=%d\n", int(res));
+            return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t check_config(const config_t *cfg)
+    {
         // Common checks
-        if (cfg.enMode == M_NONE)
+        if (cfg->enMode == M_NONE)
         {
             fprintf(stderr, "Sweep or deconvolution operating mode should be selected\n");
             return STATUS_INVALID_VALUE;
         }
 
-        // Check that output file name is present
-        if (cfg.sOutFile.is_empty())
+        // Check that output file name is present, batch jobs specify output files in the manifest
+        if ((cfg->enMode != M_BATCH) && (cfg->sOutFile.is_empty()))
         {
             fprintf(stderr, "Not specified required output file name\n");
             return STATUS_INVALID_VALUE;
         }
 
         // Check sample rate
-        if ((cfg.nSampleRate < MIN_SAMPLE_RATE) || (cfg.nSampleRate > MAX_SAMPLE_RATE))
+        if ((cfg->nSampleRate < MIN_SAMPLE_RATE) || (cfg->nSampleRate > MAX_SAMPLE_RATE))
         {
             fprintf(stderr, "Unsupported sample rate\n");
             return STATUS_INVALID_VALUE;
         }
 
-        // Check mode
-        if (cfg.enMode == M_SWEEP)
-            return generate_sweep(&cfg);
-        if (cfg.enMode == M_DECONVOLVE)
-            return deconvolve(&cfg);
+        // Check exponential sweep parameters, they are also required to deconvolve the recording
+        if (cfg->nSweepType == SWEEP_EXP)
+        {
+            if ((cfg->fStartFreq <= 0.0f) || (cfg->fEndFreq <= cfg->fStartFreq) || (cfg->fSweepLength <= 0.0f))
+            {
+                fprintf(stderr, "Exponential sine sweep requires positive start frequency, greater end frequency and positive length\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+
+        // Check harmonic distortion extraction
+        if ((cfg->nHarmonics < 0) || (cfg->nHarmonics == 1))
+        {
+            fprintf(stderr, "Invalid number of harmonics, should be at least 2\n");
+            return STATUS_INVALID_VALUE;
+        }
+        else if (cfg->nHarmonics > 0)
+        {
+            if (cfg->nSweepType != SWEEP_EXP)
+            {
+                fprintf(stderr, "Harmonic distortion extraction requires exponential sine sweep\n");
+                return STATUS_INVALID_VALUE;
+            }
+            if ((cfg->bStream) || (cfg->enMode == M_BATCH))
+            {
+                fprintf(stderr, "Harmonic distortion extraction is not supported in streaming and batch modes\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+
+        // Check repetitions of the sine sweep
+        if (cfg->nRepeats < 1)
+        {
+            fprintf(stderr, "Invalid number of repeats, should be at least 1\n");
+            return STATUS_INVALID_VALUE;
+        }
+        else if (cfg->nRepeats > 1)
+        {
+            if (cfg->fSweepLength <= 0.0f)
+            {
+                fprintf(stderr, "Sine sweep repetitions require positive sweep length\n");
+                return STATUS_INVALID_VALUE;
+            }
+            if ((cfg->bStream) || (cfg->enMode == M_BATCH))
+            {
+                fprintf(stderr, "Sine sweep repetitions are not supported in streaming and batch modes\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+
+        // Check block size
+        if (cfg->nBlockSize < 0)
+        {
+            fprintf(stderr, "Invalid block size\n");
+            return STATUS_INVALID_VALUE;
+        }
+
+        // Check number of threads
+        if (cfg->nThreads < 0)
+        {
+            fprintf(stderr, "Invalid number of threads\n");
+            return STATUS_INVALID_VALUE;
+        }
+
+        // Check latency report
+        if ((cfg->bLatency) && ((cfg->bStream) || (cfg->enMode != M_DECONVOLVE)))
+        {
+            fprintf(stderr, "Latency report is supported only for deconvolution in memory\n");
+            return STATUS_INVALID_VALUE;
+        }
+        if ((cfg->bLatency) && (cfg->sLatencyFile.is_empty()) &&
+            (cfg->nStats != STATS_NONE) && (cfg->sStatsFile.is_empty()))
+        {
+            fprintf(stderr, "Latency report and statistics can not be both printed to the standard output\n");
+            return STATUS_INVALID_VALUE;
+        }
+
+        // Check regularized inverse filtering
+        if (cfg->bRegularize)
+        {
+            if (cfg->fRegLevel >= 0.0f)
+            {
+                fprintf(stderr, "Regularization level should be negative\n");
+                return STATUS_INVALID_VALUE;
+            }
+            if ((cfg->fStartFreq <= 0.0f) || (cfg->fEndFreq <= cfg->fStartFreq))
+            {
+                fprintf(stderr, "Regularized inverse filtering requires positive start frequency and greater end frequency\n");
+                return STATUS_INVALID_VALUE;
+            }
+            if (cfg->bStream)
+            {
+                fprintf(stderr, "Regularized inverse filtering is not supported in streaming mode\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+
+        // Check output file format
+        if ((cfg->nOutContainer == CONTAINER_FLAC) && (cfg->nOutFormat == SAMPLE_F32))
+        {
+            fprintf(stderr, "FLAC output requires integer sample format\n");
+            return STATUS_INVALID_VALUE;
+        }
+
+        // Check impulse response length
+        if (cfg->fIRLength < 0.0f)
+        {
+            fprintf(stderr, "Invalid impulse response length\n");
+            return STATUS_INVALID_VALUE;
+        }
+
+        // Check the window of the impulse response and the selection of input channels
+        if ((cfg->fWindowLength > 0.0f) || (cfg->vChannels.size() > 0))
+        {
+            if ((cfg->bStream) || (cfg->enMode != M_DECONVOLVE))
+            {
+                fprintf(stderr, "Impulse response window and channel selection are supported only for deconvolution in memory\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+        if (cfg->fWindowLength > 0.0f)
+        {
+            if (cfg->nHarmonics > 0)
+            {
+                fprintf(stderr, "Impulse response window can not be used with harmonic distortion extraction\n");
+                return STATUS_INVALID_VALUE;
+            }
+            if (cfg->bRegularize)
+            {
+                fprintf(stderr, "Impulse response window can not be used with regularized inverse filtering\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+
+        // Check multichannel reference options
+        if ((cfg->bMatrix) || (cfg->vRefMap.size() > 0))
+        {
+            if ((cfg->bStream) || (cfg->enMode == M_BATCH))
+            {
+                fprintf(stderr, "Reference map and matrix mode are not supported in streaming and batch modes\n");
+                return STATUS_INVALID_VALUE;
+            }
+        }
+
+        // Check memory limit
+        if (cfg->nMaxMemory < 0)
+        {
+            fprintf(stderr, "Invalid memory limit\n");
+            return STATUS_INVALID_VALUE;
+        }
+        else if ((cfg->nMaxMemory > 0) && (cfg->enMode == M_BATCH))
+        {
+            fprintf(stderr, "Memory limit is not supported in batch mode\n");
+            return STATUS_INVALID_VALUE;
+        }
 
         return STATUS_OK;
     }
+
+    int main(int argc, const char **argv)
+    {
+        config_t cfg;
+
+        // Parse command line
+        status_t res = parse_cmdline(&cfg, argc, argv);
+        if (res != STATUS_OK)
+            return res;
+
+        // The server receives jobs with their own configuration
+        if (cfg.enMode == M_SERVE)
+            return serve(&cfg);
+
+        // Check the configuration and run the selected mode
+        if ((res = check_config(&cfg)) != STATUS_OK)
+            return res;
+
+        return run(&cfg);
+    }
 }
 
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <private/writer.h>
+
+#include <new>
+
+#define WRITER_BLOCK_SIZE           0x4000
+#define WRITER_POLL_PERIOD          1       /* ms */
+
+namespace room_raider
+{
+    using namespace lsp;
+
+    static size_t stream_sample_format(size_t format)
+    {
+        switch (format)
+        {
+            case SAMPLE_S24:    return mm::SFMT_S24_CPU;
+            case SAMPLE_S16:    return mm::SFMT_S16_CPU;
+            default:            break;
+        }
+        return mm::SFMT_F32_CPU;
+    }
+
+    static size_t stream_file_format(size_t container)
+    {
+        switch (container)
+        {
+            case CONTAINER_RF64:    return mm::AFMT_RF64 | mm::CFMT_PCM;
+            case CONTAINER_FLAC:    return mm::AFMT_FLAC | mm::CFMT_PCM;
+            default:                break;
+        }
+        return mm::AFMT_WAV | mm::CFMT_PCM;
+    }
+
+    static status_t write_block(writer_t *w, const float *src, size_t frames)
+    {
+        while (frames > 0)
+        {
+            ssize_t nwritten    = w->sStream.write(src, frames);
+            if (nwritten <= 0)
+                return (nwritten < 0) ? status_t(-nwritten) : STATUS_IO_ERROR;
+
+            src                += nwritten * w->nChannels;
+            frames             -= nwritten;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t writer_thread(void *arg)
+    {
+        writer_t *w         = static_cast<writer_t *>(arg);
+
+        // Each additional thread should initialize DSP context
+        dsp::context_t ctx;
+        dsp::start(&ctx);
+
+        // Take the submitted blocks until the writer is closed
+        while (true)
+        {
+            w->sLock.lock();
+            const float *src    = w->pPending;
+            size_t frames       = w->nPending;
+            bool close          = w->bClose;
+            w->sLock.unlock();
+
+            if (src == NULL)
+            {
+                if (close)
+                    break;
+                ipc::Thread::sleep(WRITER_POLL_PERIOD);
+                continue;
+            }
+
+            status_t res        = write_block(w, src, frames);
+
+            // Release the buffer of the block
+            w->sLock.lock();
+            w->nStatus          = res;
+            w->pPending         = NULL;
+            w->sLock.unlock();
+        }
+
+        dsp::finish(&ctx);
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Wait until the thread has written the submitted block
+     */
+    static status_t writer_wait(writer_t *w)
+    {
+        while (true)
+        {
+            w->sLock.lock();
+            bool idle           = w->pPending == NULL;
+            status_t res        = w->nStatus;
+            w->sLock.unlock();
+
+            if (idle)
+                return res;
+            ipc::Thread::sleep(WRITER_POLL_PERIOD);
+        }
+    }
+
+    void init_writer(writer_t *w)
+    {
+        w->pThread          = NULL;
+        w->nChannels        = 0;
+        w->nCapacity        = 0;
+        w->nCurrent         = 0;
+        w->vBuffers[0]      = NULL;
+        w->vBuffers[1]      = NULL;
+        w->pPending         = NULL;
+        w->nPending         = 0;
+        w->bClose           = false;
+        w->nStatus          = STATUS_OK;
+        w->pArena           = NULL;
+        w->nMark            = 0;
+        w->pData            = NULL;
+    }
+
+    status_t open_writer(writer_t *w, const LSPString *path, size_t channels, size_t srate, wssize_t frames,
+        size_t format, size_t container, size_t capacity, arena_t *arena)
+    {
+        size_t size         = capacity * channels;
+        size_t mark         = (arena != NULL) ? arena->nUsed : 0;
+        float *ptr          = (arena != NULL) ? arena_alloc<float>(arena, size * 2) : NULL;
+        if (ptr == NULL)
+        {
+            arena               = NULL;
+            if ((ptr = alloc_aligned<float>(w->pData, size * 2)) == NULL)
+                return STATUS_NO_MEM;
+        }
+
+        mm::audio_stream_t fmt;
+        fmt.srate           = srate;
+        fmt.channels        = channels;
+        fmt.frames          = frames;
+        fmt.format          = stream_sample_format(format);
+
+        status_t res        = w->sStream.open(path, &fmt, stream_file_format(container));
+        if (res != STATUS_OK)
+        {
+            if (w->pData != NULL)
+            {
+                free_aligned(w->pData);
+                w->pData            = NULL;
+            }
+            if (arena != NULL)
+                rewind_arena(arena, mark);
+            return res;
+        }
+
+        w->nChannels        = channels;
+        w->nCapacity        = capacity;
+        w->nCurrent         = 0;
+        w->vBuffers[0]      = ptr;
+        w->vBuffers[1]      = &ptr[size];
+        w->pPending         = NULL;
+        w->nPending         = 0;
+        w->bClose           = false;
+        w->nStatus          = STATUS_OK;
+        w->pArena           = arena;
+        w->nMark            = mark;
+
+        // Blocks are written synchronously if the thread can not be started
+        w->pThread          = new (std::nothrow) ipc::Thread(writer_thread, w);
+        if ((w->pThread != NULL) && (w->pThread->start() != STATUS_OK))
+        {
+            delete w->pThread;
+            w->pThread          = NULL;
+        }
+
+        return STATUS_OK;
+    }
+
+    float *writer_buffer(writer_t *w)
+    {
+        return w->vBuffers[w->nCurrent];
+    }
+
+    status_t writer_submit(writer_t *w, size_t frames)
+    {
+        // The buffer of the previous block is reused only after it has been written
+        status_t res        = writer_wait(w);
+        if (res != STATUS_OK)
+            return res;
+        if (frames <= 0)
+            return STATUS_OK;
+
+        const float *src    = w->vBuffers[w->nCurrent];
+        w->nCurrent        ^= 1;
+        if (w->pThread == NULL)
+        {
+            w->nStatus          = write_block(w, src, frames);
+            return w->nStatus;
+        }
+
+        w->sLock.lock();
+        w->pPending         = src;
+        w->nPending         = frames;
+        w->sLock.unlock();
+
+        return STATUS_OK;
+    }
+
+    status_t close_writer(writer_t *w)
+    {
+        status_t res        = writer_wait(w);
+        if (w->pThread != NULL)
+        {
+            w->sLock.lock();
+            w->bClose           = true;
+            w->sLock.unlock();
+
+            w->pThread->join();
+            delete w->pThread;
+            w->pThread          = NULL;
+        }
+        status_t cres       = w->sStream.close();
+
+        if (w->pData != NULL)
+        {
+            free_aligned(w->pData);
+            w->pData            = NULL;
+        }
+        if (w->pArena != NULL)
+        {
+            rewind_arena(w->pArena, w->nMark);
+            w->pArena           = NULL;
+        }
+        w->vBuffers[0]      = NULL;
+        w->vBuffers[1]      = NULL;
+
+        return (res != STATUS_OK) ? res : cres;
+    }
+
+    size_t writer_arena_size(size_t channels)
+    {
+        return arena_size<float>(WRITER_BLOCK_SIZE * channels * 2);
+    }
+
+    status_t save_window(const config_t *cfg, const dspu::Sample &src, size_t first, size_t length, const LSPString *path,
+        arena_t *arena)
+    {
+        writer_t w;
+        init_writer(&w);
+
+        size_t channels     = src.channels();
+        length              = lsp_min(length, src.length() - first);
+
+        status_t res        = open_writer(&w, path, channels, src.sample_rate(), length,
+            cfg->nOutFormat, cfg->nOutContainer, WRITER_BLOCK_SIZE, arena);
+        if (res != STATUS_OK)
+            return res;
+
+        // Interleave the next block while the previous one is being written
+        for (size_t offset = 0; offset < length; )
+        {
+            size_t count        = lsp_min(length - offset, w.nCapacity);
+            float *buf          = writer_buffer(&w);
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                const float *s      = &src.getBuffer(i)[first + offset];
+                float *d            = &buf[i];
+                for (size_t j=0; j<count; ++j, d += channels)
+                    *d                  = s[j];
+            }
+
+            if ((res = writer_submit(&w, count)) != STATUS_OK)
+                break;
+            offset             += count;
+        }
+
+        status_t cres       = close_writer(&w);
+        return (res != STATUS_OK) ? res : cres;
+    }
+}
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 17 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/mtest.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/Dir.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/runtime/system.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#include <private/config.h>
+#include <private/dsp.h>
+#include <private/resample.h>
+
+#define SAMPLE_RATE         48000
+#define SWEEP_LENGTH        1000.0f     // Length of the sine sweep, ms
+#define MAX_DELAY           4800        // Maximum latency of the simulated capture, samples
+#define MEAN_ERROR_LIMIT    0.15        // Default limit of the mean RMS error relative to the original impulse response
+#define MAX_ERROR_LIMIT     0.3         // Default limit of the RMS error of each impulse response
+#define LATENCY_LIMIT       1.0         // Default limit of the latency error, samples
+#define TIME_LIMIT          1.0         // Default limit of the time of one deconvolution, seconds
+
+/**
+ * Deconvolves the capture simulated for each impulse response of the corpus and checks
+ * the statistics of errors and the time of deconvolution. Usage:
+ *
+ *   room-raider-test mtest room_raider.corpus --args <directory> [mean error] [max error] [latency] [time]
+ *
+ * The directory contains audio files with impulse responses, each channel of the file is
+ * simulated as one microphone with it's own latency. Optional arguments override the limits.
+ */
+MTEST_BEGIN("room_raider", corpus)
+
+    /**
+     * Running statistics updated with the Welford's algorithm
+     */
+    typedef struct running_t
+    {
+        size_t      nCount;             // Number of values
+        double      fMean;              // Mean value
+        double      fM2;                // Sum of squared deviations from the mean
+        double      fMin;               // Minimum value
+        double      fMax;               // Maximum value
+    } running_t;
+
+    typedef struct limits_t
+    {
+        double      fMeanError;         // Limit of the mean RMS error
+        double      fMaxError;          // Limit of the RMS error of each response
+        double      fLatency;           // Limit of the latency error, samples
+        double      fTime;              // Limit of the time of one deconvolution, seconds
+    } limits_t;
+
+    typedef struct corpus_t
+    {
+        running_t   sError;             // RMS error relative to the original impulse response
+        running_t   sLatency;           // Absolute latency error, samples
+        running_t   sTime;              // Time of deconvolution, seconds
+        size_t      nSkipped;           // Number of files which are not audio files
+    } corpus_t;
+
+    void init_running(running_t *r)
+    {
+        r->nCount   = 0;
+        r->fMean    = 0.0;
+        r->fM2      = 0.0;
+        r->fMin     = 0.0;
+        r->fMax     = 0.0;
+    }
+
+    void update_running(running_t *r, double x)
+    {
+        r->fMin     = (r->nCount > 0) ? lsp_min(r->fMin, x) : x;
+        r->fMax     = (r->nCount > 0) ? lsp_max(r->fMax, x) : x;
+
+        double d    = x - r->fMean;
+        r->fMean   += d / double(++r->nCount);
+        r->fM2     += d * (x - r->fMean);
+    }
+
+    void print_running(const char *name, const running_t *r)
+    {
+        double dev  = (r->nCount > 1) ? sqrt(r->fM2 / (r->nCount - 1)) : 0.0;
+        printf("%s: count=%d, mean=%.6f, deviation=%.6f, min=%.6f, max=%.6f\n",
+            name, int(r->nCount), r->fMean, dev, r->fMin, r->fMax);
+    }
+
+    /**
+     * Compute RMS error between two responses normalized to the unit peak, relative to the RMS
+     * of the expected response
+     */
+    double rms_error(const float *a, const float *b, size_t length)
+    {
+        double pa = 0.0, pb = 0.0;
+        for (size_t i=0; i<length; ++i)
+        {
+            pa  = lsp_max(pa, fabs(double(a[i])));
+            pb  = lsp_max(pb, fabs(double(b[i])));
+        }
+        if ((pa <= 0.0) || (pb <= 0.0))
+            return 1.0;
+
+        double err = 0.0, sum = 0.0;
+        for (size_t i=0; i<length; ++i)
+        {
+            double d    = a[i] / pa - b[i] / pb;
+            err        += d * d;
+            sum        += (b[i] / pb) * (b[i] / pb);
+        }
+
+        return sqrt(err / sum);
+    }
+
+    /**
+     * Simulate the capture: the reference delayed by the latency and passed through the room,
+     * the convolution is computed with the transform of enough length to avoid the wrap-around
+     */
+    void simulate(float *dst, const float *ref, size_t length, const float *ir, size_t ir_length, size_t delay)
+    {
+        size_t rank     = 0;
+        while ((size_t(1) << rank) < length + ir_length)
+            ++rank;
+        size_t fft_size = size_t(1) << rank;
+
+        dspu::Sample buf;
+        MTEST_ASSERT(buf.init(4, fft_size, fft_size));
+        float *re       = buf.getBuffer(0);
+        float *im       = buf.getBuffer(1);
+        float *ir_re    = buf.getBuffer(2);
+        float *ir_im    = buf.getBuffer(3);
+        for (size_t i=0; i<4; ++i)
+            dsp::fill_zero(buf.getBuffer(i), fft_size);
+
+        dsp::copy(&re[delay], ref, length - delay);
+        dsp::copy(ir_re, ir, ir_length);
+        dsp::direct_fft(re, im, re, im, rank);
+        dsp::direct_fft(ir_re, ir_im, ir_re, ir_im, rank);
+        dsp::complex_mul3(re, im, re, im, ir_re, ir_im, fft_size);
+        dsp::reverse_fft(re, im, re, im, rank);
+        dsp::copy(dst, re, length);
+    }
+
+    void test_file(room_raider::config_t *cfg, const dspu::Sample &sweep, const LSPString *path, corpus_t *c)
+    {
+        dspu::Sample ir;
+        if (ir.load(path) != STATUS_OK)
+        {
+            ++c->nSkipped;
+            return;
+        }
+        MTEST_ASSERT(room_raider::resample(&ir, SAMPLE_RATE, 1) == STATUS_OK);
+
+        size_t channels = ir.channels();
+        size_t ir_length = ir.length();
+        printf("Testing %s channels=%d length=%d...\n", path->get_native(), int(channels), int(ir_length));
+
+        // The reference is the sweep padded for the latency and the response of the room,
+        // so the whole response is kept in the capture of the same length
+        size_t length   = sweep.length() + MAX_DELAY + ir_length;
+        dspu::Sample ref, in, out;
+        MTEST_ASSERT(ref.init(1, length, length));
+        MTEST_ASSERT(in.init(channels, length, length));
+        MTEST_ASSERT(out.init(channels, length, length));
+        dsp::fill_zero(ref.getBuffer(0), length);
+        dsp::copy(ref.getBuffer(0), sweep.getBuffer(0), sweep.length());
+
+        // The latency of each channel is derived from the file name, so it does not depend on the order of files
+        lltl::darray<size_t> delays;
+        size_t seed     = path->hash();
+        for (size_t i=0; i<channels; ++i)
+        {
+            seed            = seed * 1103515245 + 12345;
+            size_t *delay   = delays.add();
+            MTEST_ASSERT(delay != NULL);
+            *delay          = (seed >> 8) % MAX_DELAY;
+            simulate(in.getBuffer(i), ref.getBuffer(0), length, ir.getBuffer(i), ir_length, *delay);
+        }
+
+        lltl::darray<room_raider::latency_t> latency;
+        MTEST_ASSERT(latency.add_n(channels) != NULL);
+
+        system::time_t start, end;
+        system::get_time(&start);
+        MTEST_ASSERT(room_raider::deconvolve(cfg, in, ref, out, 0, latency.array(), NULL, NULL) == STATUS_OK);
+        system::get_time(&end);
+
+        double time     = (end.seconds - start.seconds) + (end.nanos - start.nanos) * 1e-9;
+        update_running(&c->sTime, time);
+        printf("  deconvolution time: %.3f ms\n", time * 1000.0);
+
+        // Each output channel should contain the original response at it's latency
+        for (size_t i=0; i<channels; ++i)
+        {
+            size_t delay        = *delays.uget(i);
+            const float *src    = ir.getBuffer(i);
+            double err          = rms_error(&out.getBuffer(i)[delay], src, ir_length);
+            double lat          = fabs(latency.uget(i)->fDelay - double(delay + dsp::abs_max_index(src, ir_length)));
+            printf("  channel %d: delay=%d, IR error=%.6f, latency error=%.3f\n", int(i), int(delay), err, lat);
+
+            update_running(&c->sError, err);
+            update_running(&c->sLatency, lat);
+        }
+    }
+
+    MTEST_MAIN
+    {
+        MTEST_ASSERT_MSG(argc >= 1, "The directory with impulse responses is required");
+
+        limits_t limits;
+        limits.fMeanError   = (argc >= 2) ? atof(argv[1]) : MEAN_ERROR_LIMIT;
+        limits.fMaxError    = (argc >= 3) ? atof(argv[2]) : MAX_ERROR_LIMIT;
+        limits.fLatency     = (argc >= 4) ? atof(argv[3]) : LATENCY_LIMIT;
+        limits.fTime        = (argc >= 5) ? atof(argv[4]) : TIME_LIMIT;
+
+        room_raider::config_t cfg;
+        cfg.nSampleRate     = SAMPLE_RATE;
+        cfg.fSweepLength    = SWEEP_LENGTH;
+        cfg.nThreads        = 1;
+
+        size_t length       = room_raider::sweep_period(&cfg);
+        dspu::Sample sweep;
+        MTEST_ASSERT(sweep.init(1, length, length));
+        MTEST_ASSERT(room_raider::synth_test_sweep(&cfg, sweep) == STATUS_OK);
+
+        corpus_t c;
+        init_running(&c.sError);
+        init_running(&c.sLatency);
+        init_running(&c.sTime);
+        c.nSkipped          = 0;
+
+        io::Dir dir;
+        MTEST_ASSERT_MSG(dir.open(argv[0]) == STATUS_OK, "Could not open directory %s", argv[0]);
+
+        LSPString name;
+        io::Path path;
+        while (dir.read(&name, false) == STATUS_OK)
+        {
+            if (name.first() == '.')
+                continue;
+            MTEST_ASSERT(path.set(argv[0]) == STATUS_OK);
+            MTEST_ASSERT(path.append_child(&name) == STATUS_OK);
+            test_file(&cfg, sweep, path.as_string(), &c);
+        }
+        dir.close();
+
+        printf("Processed %d responses, skipped %d files\n", int(c.sError.nCount), int(c.nSkipped));
+        print_running("IR error", &c.sError);
+        print_running("Latency error", &c.sLatency);
+        print_running("Deconvolution time", &c.sTime);
+
+        MTEST_ASSERT_MSG(c.sError.nCount > 0, "No impulse responses found in %s", argv[0]);
+        MTEST_ASSERT_MSG(c.sError.fMean <= limits.fMeanError, "Mean IR error %f exceeds %f", c.sError.fMean, limits.fMeanError);
+        MTEST_ASSERT_MSG(c.sError.fMax <= limits.fMaxError, "Max IR error %f exceeds %f", c.sError.fMax, limits.fMaxError);
+        MTEST_ASSERT_MSG(c.sLatency.fMax <= limits.fLatency, "Max latency error %f exceeds %f", c.sLatency.fMax, limits.fLatency);
+        MTEST_ASSERT_MSG(c.sTime.fMax <= limits.fTime, "Max deconvolution time %f s exceeds %f s", c.sTime.fMax, limits.fTime);
+    }
+
+MTEST_END
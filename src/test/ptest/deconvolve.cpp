@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <room-raider/deconvolver.h>
+#include <private/config.h>
+#include <private/dsp.h>
+#include <private/stats.h>
+
+#define MIN_RANK        12
+#define MAX_RANK        18
+#define MAX_CHANNELS    8
+
+namespace
+{
+    using namespace lsp;
+}
+
+PTEST_BEGIN("room_raider", deconvolve, 5, 10)
+
+    void call(const char *label, const dspu::Sample &in, const room_raider::kernel_t *kernel, dspu::Sample &out, size_t threads)
+    {
+        char buf[80];
+        sprintf(buf, "%s ch=%d len=%d j=%d", label, int(in.channels()), int(in.length()), int(threads));
+        printf("Testing %s...\n", buf);
+
+        // Estimated peak allocation: input, output, kernel and scratch buffers of each worker
+        size_t fft_size = kernel->nRadix << kernel->nRank;
+        size_t workers  = lsp_max(lsp_min(threads, (in.channels() + 1) >> 1), size_t(1));
+        size_t bytes    = (in.channels() * (in.length() + out.length()) + fft_size * 2 * (workers + 1)) * sizeof(float);
+        printf("Estimated allocation %s bytes=%d\n", buf, int(bytes));
+
+        // The peak resident set size only grows, so the delta shows the memory the calls added on top of it
+        room_raider::usage_t before, after;
+        room_raider::get_usage(&before);
+
+        PTEST_LOOP(buf,
+            room_raider::deconvolve(in, kernel, out, threads, 0, NULL);
+        );
+
+        room_raider::get_usage(&after);
+        printf("Peak RSS delta %s bytes=%llu\n", buf, (unsigned long long)(after.nPeakRSS - before.nPeakRSS));
+    }
+
+    void call_setup(const dspu::Sample &in, const dspu::Sample &ref, dspu::Sample &out)
+    {
+        char buf[80];
+        sprintf(buf, "per-call setup ch=%d len=%d", int(in.channels()), int(in.length()));
+        printf("Testing %s...\n", buf);
+
+        room_raider::config_t cfg;
+        cfg.nThreads    = 1;
+
+        PTEST_LOOP(buf,
+            room_raider::deconvolve(&cfg, in, ref, out, 0, NULL, NULL, NULL);
+        );
+    }
+
+    void call_reused(const dspu::Sample &in, const dspu::Sample &ref, dspu::Sample &out)
+    {
+        char buf[80];
+        sprintf(buf, "reused setup ch=%d len=%d", int(in.channels()), int(in.length()));
+        printf("Testing %s...\n", buf);
+
+        const float *vRef[1] = { ref.getBuffer(0) };
+        const float *vIn[2] = { in.getBuffer(0), in.getBuffer(1) };
+        float *vOut[2] = { out.getBuffer(0), out.getBuffer(1) };
+
+        room_raider::Deconvolver d;
+        d.init(vRef, 1, ref.length(), in.length(), in.channels(), 1);
+
+        PTEST_LOOP(buf,
+            d.process(vIn, in.length(), vOut, out.length());
+        );
+    }
+
+    PTEST_MAIN
+    {
+        size_t cores = ipc::Thread::system_cores();
+
+        for (size_t rank=MIN_RANK; rank <= MAX_RANK; rank += 2)
+        {
+            size_t length = size_t(1) << rank;
+
+            // Reference: the pulse with some decay
+            dspu::Sample ref;
+            ref.init(1, length, length);
+            float *buf = ref.getBuffer(0);
+            for (size_t i=0; i<length; ++i)
+                buf[i]      = sinf(i * 0.1f) * expf(-float(i) / length);
+
+            size_t radix = 1;
+            size_t fft_rank = room_raider::deconv_rank(length, length, &radix);
+            room_raider::kernel_t kernel;
+            room_raider::init_kernel(&kernel);
+            room_raider::build_kernel(&kernel, ref, 0, radix, fft_rank, NULL);
+
+            for (size_t channels=1; channels <= MAX_CHANNELS; channels <<= 1)
+            {
+                dspu::Sample in, out;
+                in.init(channels, length, length);
+                out.init(channels, length, length);
+                for (size_t i=0; i<channels; ++i)
+                    dsp::copy(in.getBuffer(i), ref.getBuffer(0), length);
+
+                call("single", in, &kernel, out, 1);
+                if (cores > 1)
+                    call("parallel", in, &kernel, out, cores);
+            }
+
+            // Many short takes against the same reference: the setup of each call is compared
+            // with the setup kept by the deconvolver
+            {
+                dspu::Sample in, out;
+                in.init(2, length, length);
+                out.init(2, length, length);
+                for (size_t i=0; i<2; ++i)
+                    dsp::copy(in.getBuffer(i), ref.getBuffer(0), length);
+
+                call_setup(in, ref, out);
+                call_reused(in, ref, out);
+            }
+
+            room_raider::destroy_kernel(&kernel);
+            PTEST_SEPARATOR;
+        }
+    }
+
+PTEST_END
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <private/fft.h>
+
+#define MIN_RANK        12
+#define MAX_RANK        20
+#define MAX_SAMPLES     (8 << MAX_RANK)
+
+// The mixed-radix transform is compared with the power-of-two transform which would be used instead
+PTEST_BEGIN("room_raider", fft, 5, 10)
+
+    void call(float *re, float *im, size_t radix, size_t rank)
+    {
+        char buf[80];
+        size_t count = radix << rank;
+        sprintf(buf, "radix=%d rank=%d size=%d", int(radix), int(rank), int(count));
+        printf("Testing %s...\n", buf);
+
+        for (size_t i=0; i<count; ++i)
+        {
+            re[i]       = sinf(i * 0.1f);
+            im[i]       = cosf(i * 0.03f);
+        }
+
+        PTEST_LOOP(buf,
+            room_raider::mixed_direct_fft(re, im, radix, rank);
+            room_raider::mixed_reverse_fft(re, im, radix, rank);
+        );
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *re       = alloc_aligned<float>(data, MAX_SAMPLES * 2);
+        float *im       = &re[MAX_SAMPLES];
+
+        for (size_t rank=MIN_RANK; rank <= MAX_RANK; rank += 2)
+        {
+            call(re, im, 3, rank);
+            call(re, im, 1, rank + 2);
+            call(re, im, 5, rank);
+            call(re, im, 1, rank + 3);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
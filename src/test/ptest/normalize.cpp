@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <private/config.h>
+#include <private/dsp.h>
+
+#define MIN_RANK        10
+#define MAX_RANK        20
+#define MAX_CHANNELS    8
+
+namespace
+{
+    using namespace lsp;
+}
+
+PTEST_BEGIN("room_raider", normalize, 5, 1000)
+
+    void call(const char *label, dspu::Sample *dst, size_t mode)
+    {
+        char buf[80];
+        sprintf(buf, "%s ch=%d len=%d", label, int(dst->channels()), int(dst->length()));
+        printf("Testing %s...\n", buf);
+
+        // The peak level is changed on each iteration, so the gain is always applied
+        float gain = 0.5f;
+        PTEST_LOOP(buf,
+            room_raider::normalize(dst, gain, mode);
+            gain    = 1.5f - gain;
+        );
+    }
+
+    PTEST_MAIN
+    {
+        for (size_t rank=MIN_RANK; rank <= MAX_RANK; rank += 2)
+        {
+            size_t length = size_t(1) << rank;
+
+            for (size_t channels=1; channels <= MAX_CHANNELS; channels <<= 1)
+            {
+                dspu::Sample s;
+                s.init(channels, length, length);
+                for (size_t i=0; i<channels; ++i)
+                {
+                    float *buf = s.getBuffer(i);
+                    for (size_t j=0; j<length; ++j)
+                        buf[j]      = sinf(j * 0.01f) * 0.25f;
+                }
+
+                call("above", &s, room_raider::NORM_ABOVE);
+                call("always", &s, room_raider::NORM_ALWAYS);
+            }
+
+            PTEST_SEPARATOR;
+        }
+    }
+
+PTEST_END
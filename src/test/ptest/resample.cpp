@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <private/resample.h>
+
+#define MIN_RANK        14
+#define MAX_RANK        18
+#define MAX_CHANNELS    4
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct rates_t
+    {
+        size_t      src;
+        size_t      dst;
+    } rates_t;
+
+    // Each iteration converts the sample to the other rate of the pair, so the result is the mean
+    // time of both directions
+    static const rates_t rates[] =
+    {
+        { 44100, 48000 },
+        { 48000, 96000 },
+        { 0, 0 }
+    };
+
+    void copy_sample(dspu::Sample *dst, const dspu::Sample &src)
+    {
+        dst->init(src.channels(), src.length(), src.length());
+        dst->set_sample_rate(src.sample_rate());
+        for (size_t i=0; i<src.channels(); ++i)
+            dsp::copy(dst->getBuffer(i), src.getBuffer(i), src.length());
+    }
+}
+
+PTEST_BEGIN("room_raider", resample, 5, 10)
+
+    void call(const char *label, const dspu::Sample &src, size_t srate, size_t threads)
+    {
+        char buf[80];
+        sprintf(buf, "%s ch=%d len=%d %d<->%d", label, int(src.channels()), int(src.length()),
+            int(src.sample_rate()), int(srate));
+        printf("Testing %s...\n", buf);
+
+        // The estimate is not measured: the source and the resampled copy of all channels
+        // exist at the same time when the sample is converted to the higher rate
+        size_t rate     = lsp_max(srate, size_t(src.sample_rate()));
+        size_t length   = (src.length() * rate + src.sample_rate() - 1) / src.sample_rate();
+        size_t bytes    = src.channels() * (src.length() + length) * sizeof(float);
+        printf("Estimated peak allocation %s bytes=%d\n", buf, int(bytes));
+
+        // The input is copied before the loop, each iteration converts the result of the previous one
+        dspu::Sample tmp;
+        copy_sample(&tmp, src);
+        size_t targets[2] = { srate, src.sample_rate() };
+        size_t n          = 0;
+        if (threads > 0)
+        {
+            PTEST_LOOP(buf,
+                room_raider::resample(&tmp, targets[(n++) & 1], threads);
+            );
+        }
+        else
+        {
+            PTEST_LOOP(buf,
+                tmp.resample(targets[(n++) & 1]);
+            );
+        }
+    }
+
+    PTEST_MAIN
+    {
+        size_t cores = ipc::Thread::system_cores();
+
+        for (const rates_t *r = rates; r->src > 0; ++r)
+        {
+            for (size_t rank=MIN_RANK; rank <= MAX_RANK; rank += 2)
+            {
+                size_t length = size_t(1) << rank;
+
+                for (size_t channels=1; channels <= MAX_CHANNELS; channels <<= 2)
+                {
+                    dspu::Sample src;
+                    src.init(channels, length, length);
+                    src.set_sample_rate(r->src);
+                    for (size_t i=0; i<channels; ++i)
+                    {
+                        float *buf = src.getBuffer(i);
+                        for (size_t j=0; j<length; ++j)
+                            buf[j]      = sinf(j * (0.01f + i * 0.001f));
+                    }
+
+                    call("sample", src, r->dst, 0);
+                    call("single", src, r->dst, 1);
+                    if (cores > 1)
+                        call("parallel", src, r->dst, cores);
+                }
+            }
+
+            PTEST_SEPARATOR;
+        }
+    }
+
+PTEST_END
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <private/config.h>
+#include <private/dsp.h>
+
+#define SRATE           (8 * 48000)
+#define MIN_RANK        10
+#define MAX_RANK        20
+#define MAX_SAMPLES     (1 << MAX_RANK)
+
+namespace
+{
+    using namespace lsp;
+
+    typedef void (* synth_sweep_t)(const room_raider::config_t *cfg, float *dst, size_t first, size_t count, size_t srate);
+
+    // The previous implementation: double-precision sin() and fmod() for each sample
+    void synth_sweep_naive(const room_raider::config_t *cfg, float *dst, size_t first, size_t count, size_t srate)
+    {
+        double dSlope = 1000.0 * (double(cfg->fEndFreq) - cfg->fStartFreq) / cfg->fSweepLength;
+        double dRate = (cfg->nSweepType == room_raider::SWEEP_EXP) ? room_raider::exp_sweep_rate(cfg) : 0.0;
+
+        for (size_t n = 0; n < count; ++n)
+        {
+            double dTime = double(first + n) / srate;
+            double dPhase = (cfg->nSweepType == room_raider::SWEEP_EXP) ?
+                2.0 * M_PI * cfg->fStartFreq * dRate * (exp(dTime / dRate) - 1.0) :
+                2.0 * M_PI * (0.5 * dSlope * dTime * dTime + cfg->fStartFreq * dTime);
+            dPhase = fmod(dPhase + M_PI, 2.0 * M_PI);
+            dPhase = dPhase >= 0.0 ? (dPhase - M_PI) : (dPhase + M_PI);
+            dst[n] = sin(dPhase);
+        }
+    }
+}
+
+PTEST_BEGIN("room_raider", sweep, 5, 10)
+
+    void call(const char *label, const room_raider::config_t *cfg, float *dst, size_t count, synth_sweep_t func)
+    {
+        char buf[80];
+        sprintf(buf, "%s x %d", label, int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            func(cfg, dst, 0, count, SRATE);
+        );
+    }
+
+    void call_oversampled(room_raider::config_t *cfg, size_t count)
+    {
+        char buf[80];
+        sprintf(buf, "oversampled x %d", int(count));
+        printf("Testing %s samples...\n", buf);
+
+        dspu::Sample out;
+        out.init(1, count, count);
+        cfg->fSweepLength   = (count * 1000.0f) / cfg->nSampleRate;
+
+        PTEST_LOOP(buf,
+            room_raider::synth_test_sweep(cfg, out);
+        );
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *dst      = alloc_aligned<float>(data, MAX_SAMPLES);
+
+        room_raider::config_t cfg;
+        cfg.fStartFreq      = 10.0f;
+        cfg.fEndFreq        = 20000.0f;
+        cfg.fSweepLength    = 60000.0f;
+
+        for (size_t i=MIN_RANK; i <= MAX_RANK; ++i)
+        {
+            size_t count = 1 << i;
+
+            cfg.nSweepType  = room_raider::SWEEP_LINEAR;
+            call("linear naive", &cfg, dst, count, synth_sweep_naive);
+            call("linear block", &cfg, dst, count, room_raider::synth_sweep);
+
+            cfg.nSweepType  = room_raider::SWEEP_EXP;
+            call("exp naive", &cfg, dst, count, synth_sweep_naive);
+            call("exp block", &cfg, dst, count, room_raider::synth_sweep);
+
+            PTEST_SEPARATOR;
+        }
+
+        // The complete test sweep with oversampling
+        for (size_t i=MIN_RANK; i <= MAX_RANK; i += 2)
+        {
+            cfg.nSweepType  = room_raider::SWEEP_LINEAR;
+            call_oversampled(&cfg, 1 << i);
+            cfg.nSweepType  = room_raider::SWEEP_EXP;
+            call_oversampled(&cfg, 1 << i);
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/arena.h>
+#include <private/dsp.h>
+
+#define REF_LENGTH          2000        // Length of the reference, samples
+#define IN_LENGTH           5000        // Length of the input, samples
+#define CHANNELS            3           // Number of input channels
+
+UTEST_BEGIN("room_raider", arena)
+
+    void test_slices()
+    {
+        printf("Testing slices of the arena...\n");
+
+        room_raider::arena_t a;
+        room_raider::init_arena(&a, false);
+
+        // Empty arena has no space
+        UTEST_ASSERT(room_raider::arena_alloc<float>(&a, 1) == NULL);
+
+        size_t size         = room_raider::arena_size<float>(100) + room_raider::arena_size<float>(33);
+        UTEST_ASSERT(room_raider::reserve_arena(&a, size) == STATUS_OK);
+        UTEST_ASSERT(a.nCapacity >= size);
+        uint8_t *data       = a.vData;
+
+        // Slices are aligned and do not overlap
+        float *s1           = room_raider::arena_alloc<float>(&a, 100);
+        float *s2           = room_raider::arena_alloc<float>(&a, 33);
+        UTEST_ASSERT((s1 != NULL) && (s2 != NULL));
+        UTEST_ASSERT((uintptr_t(s1) & 0x3f) == 0);
+        UTEST_ASSERT((uintptr_t(s2) & 0x3f) == 0);
+        UTEST_ASSERT(s2 >= &s1[100]);
+        UTEST_ASSERT(room_raider::arena_alloc<float>(&a, a.nCapacity) == NULL);
+
+        // The used arena can not be reallocated
+        UTEST_ASSERT(room_raider::reserve_arena(&a, size * 2) == STATUS_BAD_STATE);
+
+        // Rewind returns only slices taken after the mark
+        size_t mark         = a.nUsed;
+        UTEST_ASSERT(room_raider::arena_alloc<float>(&a, 1) == NULL);
+        room_raider::rewind_arena(&a, room_raider::arena_size<float>(100));
+        UTEST_ASSERT(room_raider::arena_alloc<float>(&a, 33) == s2);
+        UTEST_ASSERT(a.nUsed == mark);
+
+        // Reset keeps the memory, smaller reservation does not reallocate it
+        room_raider::reset_arena(&a);
+        UTEST_ASSERT(a.nUsed == 0);
+        UTEST_ASSERT(room_raider::reserve_arena(&a, size / 2) == STATUS_OK);
+        UTEST_ASSERT(a.vData == data);
+        UTEST_ASSERT(room_raider::arena_alloc<float>(&a, 100) == s1);
+
+        // Larger reservation of the empty arena reallocates it
+        room_raider::reset_arena(&a);
+        UTEST_ASSERT(room_raider::reserve_arena(&a, size * 4) == STATUS_OK);
+        UTEST_ASSERT(a.nCapacity >= size * 4);
+
+        room_raider::destroy_arena(&a);
+        UTEST_ASSERT(a.vData == NULL);
+        UTEST_ASSERT(a.nCapacity == 0);
+    }
+
+    void test_deconvolve(size_t threads, bool huge_pages)
+    {
+        printf("Testing deconvolution with arena threads=%d huge_pages=%s...\n", int(threads), (huge_pages) ? "true" : "false");
+
+        dspu::Sample ref, in, out, expected;
+        UTEST_ASSERT(ref.init(1, REF_LENGTH, REF_LENGTH));
+        UTEST_ASSERT(in.init(CHANNELS, IN_LENGTH, IN_LENGTH));
+        UTEST_ASSERT(out.init(CHANNELS, IN_LENGTH, IN_LENGTH));
+        UTEST_ASSERT(expected.init(CHANNELS, IN_LENGTH, IN_LENGTH));
+
+        float *buf          = ref.getBuffer(0);
+        for (size_t i=0; i<REF_LENGTH; ++i)
+            buf[i]              = sinf(i * (0.03f + i * 2e-4f));
+        for (size_t c=0; c<CHANNELS; ++c)
+        {
+            float *dst          = in.getBuffer(c);
+            for (size_t i=0; i<IN_LENGTH; ++i)
+                dst[i]              = ((i >= 31 * (c + 1)) && (i - 31 * (c + 1) < REF_LENGTH)) ? buf[i - 31 * (c + 1)] : 0.0f;
+        }
+
+        size_t radix        = 1;
+        size_t rank         = room_raider::deconv_rank(IN_LENGTH, REF_LENGTH, &radix);
+        room_raider::kernel_t k;
+        room_raider::init_kernel(&k);
+        UTEST_ASSERT(room_raider::build_kernel(&k, ref, 0, radix, rank, NULL) == STATUS_OK);
+        UTEST_ASSERT(room_raider::deconvolve(in, &k, expected, threads, 0, NULL) == STATUS_OK);
+
+        // The same job is processed several times with the memory reserved once
+        room_raider::arena_t a;
+        room_raider::init_arena(&a, huge_pages);
+        for (size_t job=0; job<3; ++job)
+        {
+            UTEST_ASSERT(room_raider::reserve_arena(&a, room_raider::deconv_arena_size(radix, rank, 1, threads)) == STATUS_OK);
+            uint8_t *data       = a.vData;
+            UTEST_ASSERT(room_raider::deconvolve(in, &k, out, threads, 0, &a) == STATUS_OK);
+            UTEST_ASSERT(a.nUsed == 0);
+            UTEST_ASSERT(a.vData == data);
+            room_raider::reset_arena(&a);
+
+            for (size_t c=0; c<CHANNELS; ++c)
+            {
+                const float *o      = out.getBuffer(c);
+                const float *e      = expected.getBuffer(c);
+                for (size_t i=0; i<IN_LENGTH; ++i)
+                    UTEST_ASSERT_MSG(float_equals_absolute(o[i], e[i], 1e-5f),
+                        "Job %d channel %d sample %d: %f != %f", int(job), int(c), int(i), o[i], e[i]);
+            }
+        }
+
+        room_raider::destroy_arena(&a);
+        room_raider::destroy_kernel(&k);
+    }
+
+    UTEST_MAIN
+    {
+        test_slices();
+        test_deconvolve(1, false);
+        test_deconvolve(2, true);
+    }
+
+UTEST_END
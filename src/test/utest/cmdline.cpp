@@ -46,6 +46,35 @@ UTEST_BEGIN("room_raider", cmdline)
         UTEST_ASSERT(cfg->nSampleRate == 88200);
         UTEST_ASSERT(float_equals_absolute(cfg->fNormGain, -3.0f));
         UTEST_ASSERT(cfg->nNormalize == room_raider::NORM_ALWAYS);
+        UTEST_ASSERT(cfg->nThreads == 4);
+        UTEST_ASSERT(cfg->bStream);
+        UTEST_ASSERT(cfg->nBlockSize == 8192);
+        UTEST_ASSERT(cfg->nSweepType == room_raider::SWEEP_EXP);
+        UTEST_ASSERT(cfg->nHarmonics == 3);
+        UTEST_ASSERT(cfg->nRepeats == 4);
+        UTEST_ASSERT(cfg->sInverse.equals_ascii("inverse-file.wav"));
+        UTEST_ASSERT(cfg->nMaxMemory == 512);
+        UTEST_ASSERT(float_equals_absolute(cfg->fIRLength, 250.0f));
+        UTEST_ASSERT(!cfg->bIRAuto);
+        UTEST_ASSERT(!cfg->bMatrix);
+        UTEST_ASSERT(cfg->vRefMap.size() == 4);
+        UTEST_ASSERT(*cfg->vRefMap.uget(0) == 0);
+        UTEST_ASSERT(*cfg->vRefMap.uget(1) == 0);
+        UTEST_ASSERT(*cfg->vRefMap.uget(2) == 1);
+        UTEST_ASSERT(*cfg->vRefMap.uget(3) == 2);
+        UTEST_ASSERT(cfg->nStats == room_raider::STATS_JSON);
+        UTEST_ASSERT(cfg->sStatsFile.equals_ascii("stats.json"));
+        UTEST_ASSERT(cfg->nOutFormat == room_raider::SAMPLE_S16);
+        UTEST_ASSERT(cfg->nOutContainer == room_raider::CONTAINER_RF64);
+        UTEST_ASSERT(cfg->bRegularize);
+        UTEST_ASSERT(float_equals_absolute(cfg->fRegLevel, -50.0f));
+        UTEST_ASSERT(cfg->bLatency);
+        UTEST_ASSERT(cfg->sLatencyFile.equals_ascii("latency.csv"));
+        UTEST_ASSERT(float_equals_absolute(cfg->fWindowStart, 12.5f));
+        UTEST_ASSERT(float_equals_absolute(cfg->fWindowLength, 100.0f));
+        UTEST_ASSERT(cfg->vChannels.size() == 2);
+        UTEST_ASSERT(*cfg->vChannels.uget(0) == 1);
+        UTEST_ASSERT(*cfg->vChannels.uget(1) == 3);
     }
 
     void parse_cmdline(room_raider::config_t *cfg)
@@ -63,6 +92,24 @@ UTEST_BEGIN("room_raider", cmdline)
             "-sr",  "88200",
             "-ng",  "-3.0",
             "-n",   "ALWAYS",
+            "-j",   "4",
+            "-st",
+            "-bs",  "8192",
+            "-sw",  "exp",
+            "-hm",  "3",
+            "-if",  "inverse-file.wav",
+            "-mm",  "512",
+            "-l",   "250",
+            "-rm",  "0,0,1,2",
+            "-rp",  "4",
+            "-sx",  "json",
+            "-sxf", "stats.json",
+            "-of",  "s16",
+            "-oc",  "rf64",
+            "-rg",  "-50",
+            "-lrf", "latency.csv",
+            "-iw",  "12.5:100",
+            "-ch",  "1,3",
             NULL
         };
 
@@ -77,6 +124,116 @@ UTEST_BEGIN("room_raider", cmdline)
         UTEST_ASSERT(res == STATUS_OK);
     }
 
+    void parse_batch_cmdline()
+    {
+        static const char *ext_argv[] =
+        {
+            full_name(),
+            "-b",   "manifest.csv",
+            "-j",   "2",
+            "-l",   "auto",
+            "-oc",  "flac",
+        };
+
+        room_raider::config_t cfg;
+        status_t res = room_raider::parse_cmdline(&cfg, sizeof(ext_argv)/sizeof(const char *), ext_argv);
+        UTEST_ASSERT(res == STATUS_OK);
+        UTEST_ASSERT(cfg.enMode == room_raider::M_BATCH);
+        UTEST_ASSERT(cfg.sBatch.equals_ascii("manifest.csv"));
+        UTEST_ASSERT(cfg.nThreads == 2);
+        UTEST_ASSERT(cfg.bIRAuto);
+        UTEST_ASSERT(cfg.vRefMap.size() == 0);
+        UTEST_ASSERT(cfg.nOutContainer == room_raider::CONTAINER_FLAC);
+        UTEST_ASSERT(cfg.nOutFormat == room_raider::SAMPLE_S24);
+
+        // Batch mode can not be combined with other modes
+        static const char *bad_argv[] =
+        {
+            full_name(),
+            "-d",
+            "-b",   "manifest.csv",
+        };
+
+        cfg.clear();
+        res = room_raider::parse_cmdline(&cfg, sizeof(bad_argv)/sizeof(const char *), bad_argv);
+        UTEST_ASSERT(res != STATUS_OK);
+    }
+
+    void parse_serve_cmdline()
+    {
+        static const char *ext_argv[] =
+        {
+            full_name(),
+            "-sv",  "/tmp/room-raider.sock",
+            "-j",   "4",
+        };
+
+        room_raider::config_t cfg;
+        status_t res = room_raider::parse_cmdline(&cfg, sizeof(ext_argv)/sizeof(const char *), ext_argv);
+        UTEST_ASSERT(res == STATUS_OK);
+        UTEST_ASSERT(cfg.enMode == room_raider::M_SERVE);
+        UTEST_ASSERT(cfg.sServe.equals_ascii("/tmp/room-raider.sock"));
+        UTEST_ASSERT(cfg.nThreads == 4);
+
+        // Server mode can not be combined with other modes
+        static const char *bad_argv[] =
+        {
+            full_name(),
+            "-b",   "manifest.csv",
+            "-sv",  "/tmp/room-raider.sock",
+        };
+
+        cfg.clear();
+        res = room_raider::parse_cmdline(&cfg, sizeof(bad_argv)/sizeof(const char *), bad_argv);
+        UTEST_ASSERT(res != STATUS_OK);
+    }
+
+    void parse_matrix_cmdline()
+    {
+        static const char *ext_argv[] =
+        {
+            full_name(),
+            "-d",
+            "-mx",
+        };
+
+        room_raider::config_t cfg;
+        status_t res = room_raider::parse_cmdline(&cfg, sizeof(ext_argv)/sizeof(const char *), ext_argv);
+        UTEST_ASSERT(res == STATUS_OK);
+        UTEST_ASSERT(cfg.enMode == room_raider::M_DECONVOLVE);
+        UTEST_ASSERT(cfg.bMatrix);
+        UTEST_ASSERT(cfg.nRepeats == 1);
+        UTEST_ASSERT(cfg.nStats == room_raider::STATS_NONE);
+        UTEST_ASSERT(cfg.nOutFormat == room_raider::SAMPLE_F32);
+        UTEST_ASSERT(cfg.nOutContainer == room_raider::CONTAINER_WAV);
+        UTEST_ASSERT(!cfg.bRegularize);
+        UTEST_ASSERT(!cfg.bLatency);
+        UTEST_ASSERT(float_equals_absolute(cfg.fWindowLength, 0.0f));
+        UTEST_ASSERT(cfg.vChannels.size() == 0);
+
+        // Reference channels should be non-negative integers
+        static const char *bad_maps[] = { "0,,1", "0,-1", "0,1.5", "", NULL };
+        for (const char **map = bad_maps; *map != NULL; ++map)
+        {
+            const char *bad_argv[] = { full_name(), "-d", "-rm", *map };
+
+            cfg.clear();
+            res = room_raider::parse_cmdline(&cfg, sizeof(bad_argv)/sizeof(const char *), bad_argv);
+            UTEST_ASSERT_MSG(res != STATUS_OK, "Reference map '%s' should be rejected", *map);
+        }
+
+        // The window should have non-negative start and positive length
+        static const char *bad_windows[] = { "10", "-1:10", "10:0", "10:", ":10", "a:10", NULL };
+        for (const char **window = bad_windows; *window != NULL; ++window)
+        {
+            const char *bad_argv[] = { full_name(), "-d", "-iw", *window };
+
+            cfg.clear();
+            res = room_raider::parse_cmdline(&cfg, sizeof(bad_argv)/sizeof(const char *), bad_argv);
+            UTEST_ASSERT_MSG(res != STATUS_OK, "Window '%s' should be rejected", *window);
+        }
+    }
+
     UTEST_MAIN
     {
         // Parse configuration from file and cmdline
@@ -85,6 +242,15 @@ UTEST_BEGIN("room_raider", cmdline)
 
         // Validate the final configuration
         validate_config(&cfg);
+
+        // Parse batch mode configuration
+        parse_batch_cmdline();
+
+        // Parse server mode configuration
+        parse_serve_cmdline();
+
+        // Parse matrix mode and invalid reference maps
+        parse_matrix_cmdline();
     }
 
 UTEST_END
@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/config.h>
+#include <private/dsp.h>
+
+#define SAMPLE_RATE         48000
+#define SWEEP_LENGTH        250.0f      // Length of the sine sweep, ms
+#define IR_LENGTH           2400        // Length of the synthetic impulse response, samples
+#define MODEL_TOLERANCE     1e-3        // Maximum RMS error relative to the direct cross-correlation
+#define IR_TOLERANCE        0.15        // Maximum RMS error relative to the original impulse response
+#define CALIBRATED_TOLERANCE 0.05      // Maximum RMS error of the regularized inverse filtering, not normalized
+#define WINDOW_START        5.0f        // Start of the impulse response window, ms
+#define WINDOW_LENGTH       20.0f       // Length of the impulse response window, ms
+
+UTEST_BEGIN("room_raider", deconvolve)
+
+    typedef struct capture_t
+    {
+        size_t      nChannels;          // Number of microphones
+        size_t      nDelay;             // Latency of the capture, samples
+        size_t      nThreads;           // Number of worker threads
+    } capture_t;
+
+    /**
+     * Synthesize the room response: several decaying modes with smooth onset,
+     * all modes are inside of the sweep band
+     */
+    void synth_ir(float *dst, size_t channel)
+    {
+        static const double freq[]  = { 250.0, 900.0, 3100.0, 7300.0 };
+        static const double gain[]  = { 1.0, 0.7, 0.5, 0.3 };
+
+        for (size_t n=0; n<IR_LENGTH; ++n)
+        {
+            double s = 0.0;
+            for (size_t k=0; k<4; ++k)
+                s += gain[k] * sin(2.0 * M_PI * freq[k] * (1.0 + 0.05 * channel) * n / SAMPLE_RATE + 0.3 * (k + channel));
+            dst[n]  = s * exp(-double(n) / (400.0 + 100.0 * channel)) * (1.0 - exp(-double(n) / 8.0));
+        }
+    }
+
+    /**
+     * Convolve the signal with the impulse response directly
+     */
+    void convolve(float *dst, const float *src, const float *ir, size_t length)
+    {
+        for (size_t n=0; n<length; ++n)
+        {
+            double s = 0.0;
+            for (size_t k=0; (k < IR_LENGTH) && (k <= n); ++k)
+                s      += double(ir[k]) * src[n - k];
+            dst[n]  = s;
+        }
+    }
+
+    /**
+     * Compute the cross-correlation of the capture and the reference directly for non-negative lags
+     */
+    void correlate(float *dst, const float *src, const float *ref, size_t length)
+    {
+        for (size_t lag=0; lag<IR_LENGTH; ++lag)
+        {
+            double s = 0.0;
+            for (size_t n=lag; n<length; ++n)
+                s      += double(src[n]) * ref[n - lag];
+            dst[lag]    = s;
+        }
+    }
+
+    /**
+     * Compute RMS error between two responses normalized to the unit peak, relative to the RMS
+     * of the expected response
+     */
+    double rms_error(const float *a, const float *b, size_t length)
+    {
+        double pa = 0.0, pb = 0.0;
+        for (size_t i=0; i<length; ++i)
+        {
+            pa  = lsp_max(pa, fabs(a[i]));
+            pb  = lsp_max(pb, fabs(b[i]));
+        }
+        if ((pa <= 0.0) || (pb <= 0.0))
+            return 1.0;
+
+        double err = 0.0, sum = 0.0;
+        for (size_t i=0; i<length; ++i)
+        {
+            double d    = a[i] / pa - b[i] / pb;
+            err        += d * d;
+            sum        += (b[i] / pb) * (b[i] / pb);
+        }
+
+        return sqrt(err / sum);
+    }
+
+    /**
+     * Compute RMS error between the calibrated response and the expected response without
+     * normalization, relative to the RMS of the expected response
+     */
+    double calibrated_error(const float *a, const float *b, size_t length)
+    {
+        double err = 0.0, sum = 0.0;
+        for (size_t i=0; i<length; ++i)
+        {
+            double d    = double(a[i]) - b[i];
+            err        += d * d;
+            sum        += double(b[i]) * b[i];
+        }
+
+        return (sum > 0.0) ? sqrt(err / sum) : 1.0;
+    }
+
+    void make_capture(dspu::Sample &ref, dspu::Sample &in, dspu::Sample &ir, const dspu::Sample &sweep, const capture_t *c)
+    {
+        size_t length = sweep.length();
+        UTEST_ASSERT(ref.init(1, length, length));
+        UTEST_ASSERT(in.init(c->nChannels, length, length));
+        UTEST_ASSERT(ir.init(2, IR_LENGTH, IR_LENGTH));
+
+        dsp::fill_zero(ref.getBuffer(0), length);
+        dsp::copy(ref.getBuffer(0) + c->nDelay, sweep.getBuffer(0), length - c->nDelay);
+        for (size_t i=0; i<c->nChannels; ++i)
+        {
+            synth_ir(ir.getBuffer(0), i);
+            convolve(in.getBuffer(i), ref.getBuffer(0), ir.getBuffer(0), length);
+        }
+    }
+
+    void test_capture(room_raider::config_t *cfg, const dspu::Sample &sweep, const capture_t *c)
+    {
+        size_t length = sweep.length();
+        printf("Testing capture channels=%d delay=%d threads=%d...\n", int(c->nChannels), int(c->nDelay), int(c->nThreads));
+
+        // The reference is the delayed sweep, the input is the reference passed through the room
+        dspu::Sample ref, in, out, ir;
+        make_capture(ref, in, ir, sweep, c);
+        UTEST_ASSERT(out.init(c->nChannels, length, length));
+
+        // Deconvolve, the time is checked by the corpus test and the performance test
+        room_raider::latency_t latency[8];
+        UTEST_ASSERT(c->nChannels <= 8);
+        cfg->nThreads   = c->nThreads;
+        UTEST_ASSERT(room_raider::deconvolve(cfg, in, ref, out, 0, latency, NULL, NULL) == STATUS_OK);
+
+        // Check each channel against the direct model and the original impulse response
+        for (size_t i=0; i<c->nChannels; ++i)
+        {
+            synth_ir(ir.getBuffer(0), i);
+            correlate(ir.getBuffer(1), in.getBuffer(i), ref.getBuffer(0), length);
+
+            double model_err    = rms_error(out.getBuffer(i), ir.getBuffer(1), IR_LENGTH);
+            double ir_err       = rms_error(out.getBuffer(i), ir.getBuffer(0), IR_LENGTH);
+            printf("  channel %d: model error=%.6f, IR error=%.6f\n", int(i), model_err, ir_err);
+
+            UTEST_ASSERT_MSG(model_err < MODEL_TOLERANCE, "Channel %d differs from the direct model: %f", int(i), model_err);
+            UTEST_ASSERT_MSG(ir_err < IR_TOLERANCE, "Channel %d differs from the original IR: %f", int(i), ir_err);
+
+            // The latency should point to the peak of the direct model
+            size_t peak         = dsp::abs_max_index(ir.getBuffer(1), IR_LENGTH);
+            printf("  channel %d: latency=%.3f, model peak=%d\n", int(i), latency[i].fDelay, int(peak));
+            UTEST_ASSERT_MSG(fabs(latency[i].fDelay - peak) <= 0.5, "Channel %d has wrong latency: %f", int(i), latency[i].fDelay);
+        }
+    }
+
+    void test_delay(room_raider::config_t *cfg, const dspu::Sample &sweep, const capture_t *c)
+    {
+        size_t length = sweep.length();
+        printf("Testing capture delay channels=%d delay=%d...\n", int(c->nChannels), int(c->nDelay));
+
+        // Only the input is delayed, the capture is longer than the reference by the delay and the tail
+        // of the same length, so the response at the zero lag is before the origin of time of the result
+        size_t in_length = length + c->nDelay * 2;
+        dspu::Sample ref, in, out, ir;
+        UTEST_ASSERT(ref.init(1, length, length));
+        UTEST_ASSERT(in.init(c->nChannels, in_length, in_length));
+        UTEST_ASSERT(out.init(c->nChannels, in_length, in_length));
+        UTEST_ASSERT(ir.init(2, IR_LENGTH, IR_LENGTH));
+        dsp::copy(ref.getBuffer(0), sweep.getBuffer(0), length);
+        for (size_t i=0; i<c->nChannels; ++i)
+        {
+            float *dst          = in.getBuffer(i);
+            synth_ir(ir.getBuffer(0), i);
+            dsp::fill_zero(dst, in_length);
+            convolve(&dst[c->nDelay], ref.getBuffer(0), ir.getBuffer(0), length);
+        }
+
+        room_raider::latency_t latency[8];
+        UTEST_ASSERT(c->nChannels <= 8);
+        cfg->nThreads       = c->nThreads;
+        UTEST_ASSERT(room_raider::deconvolve(cfg, in, ref, out, 0, latency, NULL, NULL) == STATUS_OK);
+
+        // The latency is the delay of the capture plus the peak of the response of the room
+        for (size_t i=0; i<c->nChannels; ++i)
+        {
+            correlate(ir.getBuffer(1), &in.getBuffer(i)[c->nDelay], ref.getBuffer(0), length);
+            size_t peak         = dsp::abs_max_index(ir.getBuffer(1), IR_LENGTH);
+            printf("  channel %d: latency=%.3f, delay=%d, IR peak=%d\n", int(i), latency[i].fDelay, int(c->nDelay), int(peak));
+            UTEST_ASSERT_MSG(fabs(latency[i].fDelay - (c->nDelay + peak)) <= 0.5,
+                "Channel %d has wrong latency: %f", int(i), latency[i].fDelay);
+        }
+    }
+
+    void test_latency()
+    {
+        printf("Testing fractional latency estimation...\n");
+
+        // The parabola is fitted exactly
+        static const float delays[] = { 10.0f, 10.3f, 57.75f, 100.5f, -1.0f };
+        float buf[128];
+        for (const float *d = delays; *d >= 0.0f; ++d)
+        {
+            for (size_t i=0; i<128; ++i)
+            {
+                float x     = i - *d;
+                buf[i]      = (fabs(x) < 5.0f) ? -(1.0f - 0.01f * x * x) : 0.0f;
+            }
+
+            room_raider::latency_t latency;
+            room_raider::estimate_latency(&latency, buf, 128);
+            UTEST_ASSERT_MSG(float_equals_absolute(latency.fDelay, *d, 1e-3f), "Latency %f estimated as %f", *d, latency.fDelay);
+            UTEST_ASSERT(latency.fPeak < 0.0f);
+        }
+    }
+
+    void test_regularized(room_raider::config_t *cfg, const dspu::Sample &sweep, const capture_t *c)
+    {
+        size_t length = sweep.length();
+        printf("Testing regularized inverse filter channels=%d delay=%d...\n", int(c->nChannels), int(c->nDelay));
+
+        dspu::Sample ref, in, out, ir;
+        make_capture(ref, in, ir, sweep, c);
+        UTEST_ASSERT(out.init(c->nChannels, length, length));
+
+        cfg->nThreads       = c->nThreads;
+        cfg->bRegularize    = true;
+        UTEST_ASSERT(room_raider::deconvolve(cfg, in, ref, out, 0, NULL, NULL, NULL) == STATUS_OK);
+        cfg->bRegularize    = false;
+
+        // The response should match the original impulse response without any normalization
+        for (size_t i=0; i<c->nChannels; ++i)
+        {
+            synth_ir(ir.getBuffer(0), i);
+            double err          = calibrated_error(out.getBuffer(i), ir.getBuffer(0), IR_LENGTH);
+            printf("  channel %d: calibrated error=%.6f\n", int(i), err);
+
+            UTEST_ASSERT_MSG(err < CALIBRATED_TOLERANCE, "Channel %d is not calibrated: %f", int(i), err);
+        }
+    }
+
+    void test_window(room_raider::config_t *cfg, const dspu::Sample &sweep, const capture_t *c)
+    {
+        size_t length = sweep.length();
+        printf("Testing window of odd channels channels=%d delay=%d...\n", int(c->nChannels), int(c->nDelay));
+
+        dspu::Sample ref, in, out, ir;
+        make_capture(ref, in, ir, sweep, c);
+
+        // Select odd input channels and the window of the response
+        cfg->nThreads       = c->nThreads;
+        cfg->fWindowStart   = WINDOW_START;
+        cfg->fWindowLength  = WINDOW_LENGTH;
+        for (size_t i=1; i<c->nChannels; i += 2)
+        {
+            size_t *ch          = cfg->vChannels.add();
+            UTEST_ASSERT(ch != NULL);
+            *ch                 = i;
+        }
+
+        size_t first = 0, window = 0;
+        UTEST_ASSERT(room_raider::ir_window(cfg, &first, &window));
+        UTEST_ASSERT(first + window <= IR_LENGTH);
+        UTEST_ASSERT(out.init(cfg->vChannels.size(), window, window));
+
+        room_raider::latency_t latency[8];
+        UTEST_ASSERT(cfg->vChannels.size() <= 8);
+        status_t res        = room_raider::deconvolve(cfg, in, ref, out, 0, latency, NULL, NULL);
+        cfg->fWindowStart   = 0.0f;
+        cfg->fWindowLength  = 0.0f;
+        cfg->vChannels.flush();
+        UTEST_ASSERT(res == STATUS_OK);
+
+        // Each output channel should match the same window of the direct model
+        for (size_t i=0; i<out.channels(); ++i)
+        {
+            size_t ch           = i * 2 + 1;
+            correlate(ir.getBuffer(1), in.getBuffer(ch), ref.getBuffer(0), length);
+
+            double err          = rms_error(out.getBuffer(i), &ir.getBuffer(1)[first], window);
+            printf("  channel %d: window error=%.6f, latency=%.3f\n", int(ch), err, latency[i].fDelay);
+
+            UTEST_ASSERT_MSG(err < MODEL_TOLERANCE, "Channel %d differs from the direct model: %f", int(ch), err);
+            UTEST_ASSERT(latency[i].fDelay >= first);
+            UTEST_ASSERT(latency[i].fDelay < first + window);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        static const capture_t captures[] =
+        {
+            { 1, 0,     1 },
+            { 2, 777,   2 },
+            { 4, 4321,  4 },
+            { 0, 0,     0 }
+        };
+
+        room_raider::config_t cfg;
+        cfg.nSampleRate     = SAMPLE_RATE;
+        cfg.fStartFreq      = 10.0f;
+        cfg.fEndFreq        = 20000.0f;
+        cfg.fSweepLength    = SWEEP_LENGTH;
+        cfg.nSweepType      = room_raider::SWEEP_LINEAR;
+
+        // The test signal: the sweep followed by the zero pad
+        size_t length       = room_raider::sweep_period(&cfg);
+        dspu::Sample sweep;
+        UTEST_ASSERT(sweep.init(1, length, length));
+        UTEST_ASSERT(room_raider::synth_test_sweep(&cfg, sweep) == STATUS_OK);
+
+        for (const capture_t *c = captures; c->nChannels > 0; ++c)
+            test_capture(&cfg, sweep, c);
+
+        // The fractional latency of the peak
+        test_latency();
+
+        // The latency of the capture longer than the reference
+        test_delay(&cfg, sweep, &captures[1]);
+
+        // The regularized inverse filter gives the calibrated response
+        test_regularized(&cfg, sweep, &captures[1]);
+
+        // The pruned deconvolution computes only selected channels and the window of the response
+        test_window(&cfg, sweep, &captures[2]);
+    }
+
+UTEST_END
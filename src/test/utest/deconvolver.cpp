@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <room-raider/deconvolver.h>
+#include <private/dsp.h>
+
+#define REF_LENGTH          3000        // Length of the reference, samples
+#define MAX_LENGTH          6000        // Maximum length of the take, samples
+#define CHANNELS            3           // Number of input channels
+#define TOLERANCE           1e-4        // Maximum difference from the deconvolution of each take
+
+UTEST_BEGIN("room_raider", deconvolver)
+
+    void make_take(dspu::Sample &in, const dspu::Sample &ref, size_t length, size_t seed)
+    {
+        UTEST_ASSERT(in.init(CHANNELS, length, length));
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            float *dst          = in.getBuffer(i);
+            const float *src    = ref.getBuffer(0);
+            size_t delay        = 17 * (i + 1) + seed;
+            for (size_t n=0; n<length; ++n)
+            {
+                float s             = (n >= delay) && (n - delay < ref.length()) ? src[n - delay] : 0.0f;
+                dst[n]              = s + 0.01f * sinf(0.37f * (n + seed * 13 + i));
+            }
+        }
+    }
+
+    int process(room_raider::Deconvolver &d, dspu::Sample &in, dspu::Sample &out)
+    {
+        const float *vIn[CHANNELS + 1];
+        float *vOut[CHANNELS + 1];
+        for (size_t i=0; i<in.channels(); ++i)
+            vIn[i]          = in.getBuffer(i);
+        for (size_t i=0; i<out.channels(); ++i)
+            vOut[i]         = out.getBuffer(i);
+
+        return d.process(vIn, in.length(), vOut, out.length());
+    }
+
+    void test_take(room_raider::Deconvolver &d, const dspu::Sample &ref, size_t length, size_t seed)
+    {
+        printf("Testing take length=%d seed=%d...\n", int(length), int(seed));
+
+        dspu::Sample in, out, expected;
+        make_take(in, ref, length, seed);
+        UTEST_ASSERT(out.init(CHANNELS, length, length));
+        UTEST_ASSERT(expected.init(CHANNELS, length, length));
+
+        // Reference result: the kernel is built for this take only
+        size_t radix    = 1;
+        size_t rank     = room_raider::deconv_rank(length, ref.length(), &radix);
+        room_raider::kernel_t kernel;
+        room_raider::init_kernel(&kernel);
+        UTEST_ASSERT(room_raider::build_kernel(&kernel, ref, 0, radix, rank, NULL) == STATUS_OK);
+        status_t res = room_raider::deconvolve(in, &kernel, expected, 1, 0, NULL);
+        room_raider::destroy_kernel(&kernel);
+        UTEST_ASSERT(res == STATUS_OK);
+
+        UTEST_ASSERT(process(d, in, out) == room_raider::DECONV_OK);
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            const float *a  = out.getBuffer(i);
+            const float *b  = expected.getBuffer(i);
+            float diff      = 0.0f;
+            for (size_t n=0; n<length; ++n)
+                diff            = lsp_max(diff, fabsf(a[n] - b[n]));
+
+            UTEST_ASSERT_MSG(diff < TOLERANCE, "Channel %d differs by %f", int(i), diff);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        // Reference: the decaying chirp
+        dspu::Sample ref;
+        UTEST_ASSERT(ref.init(1, REF_LENGTH, REF_LENGTH));
+        float *buf = ref.getBuffer(0);
+        for (size_t i=0; i<REF_LENGTH; ++i)
+            buf[i]      = sinf(i * (0.05f + i * 1e-4f)) * expf(-float(i) / REF_LENGTH);
+
+        // Processing before initialization should fail
+        room_raider::Deconvolver d;
+        dspu::Sample in, out;
+        make_take(in, ref, MAX_LENGTH, 0);
+        UTEST_ASSERT(out.init(CHANNELS, MAX_LENGTH, MAX_LENGTH));
+        UTEST_ASSERT(process(d, in, out) == room_raider::DECONV_BAD_STATE);
+
+        // The reference should be mono or have the same number of channels as the input
+        const float *vRef[2] = { ref.getBuffer(0), ref.getBuffer(0) };
+        UTEST_ASSERT(d.init(vRef, 2, REF_LENGTH, MAX_LENGTH, CHANNELS, 2) == room_raider::DECONV_BAD_ARGUMENTS);
+
+        // Several takes of different length with the same reference
+        UTEST_ASSERT(d.init(vRef, 1, REF_LENGTH, MAX_LENGTH, CHANNELS, 2) == room_raider::DECONV_OK);
+        UTEST_ASSERT(d.max_length() == MAX_LENGTH);
+        UTEST_ASSERT(d.channels() == CHANNELS);
+
+        test_take(d, ref, MAX_LENGTH, 0);
+        test_take(d, ref, 4000, 5);
+        test_take(d, ref, 1000, 9);
+        test_take(d, ref, MAX_LENGTH, 3);
+
+        // The input which is too long or misses channels should be rejected
+        make_take(in, ref, MAX_LENGTH + 1, 0);
+        UTEST_ASSERT(out.init(CHANNELS, MAX_LENGTH + 1, MAX_LENGTH + 1));
+        UTEST_ASSERT(process(d, in, out) == room_raider::DECONV_OVERFLOW);
+        const float *vIn[CHANNELS] = { in.getBuffer(0), NULL, in.getBuffer(2) };
+        float *vOut[CHANNELS] = { out.getBuffer(0), out.getBuffer(1), out.getBuffer(2) };
+        UTEST_ASSERT(d.process(vIn, 1000, vOut, 1000) == room_raider::DECONV_BAD_ARGUMENTS);
+
+        d.destroy();
+    }
+
+UTEST_END
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 16 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/fft.h>
+
+#define SMALL_RANK          6           // Rank of the transform compared with the DFT at each bin
+#define LARGE_RANK          12          // Rank of the transform which takes several exact values of twiddles
+#define LARGE_BINS          64          // Number of bins of the large transform compared with the DFT
+#define TOLERANCE           1e-4        // Maximum error relative to the RMS of the signal
+
+UTEST_BEGIN("room_raider", fft)
+
+    void test_rank()
+    {
+        printf("Testing selection of the transform size...\n");
+
+        static const size_t lengths[][3] =
+        {
+            // length, radix, rank
+            { 1024,     1,  10  },
+            { 1025,     5,  8   },
+            { 1281,     3,  9   },
+            { 1537,     1,  11  },
+            { 5952000,  3,  21  },  // 31 s at 96 kHz, both input and reference
+            { 7000000,  1,  23  },
+            { 20,       1,  5   },  // The power-of-two part of the mixed-radix transform is too small
+        };
+
+        for (size_t i=0; i<sizeof(lengths)/sizeof(lengths[0]); ++i)
+        {
+            size_t radix    = 0;
+            size_t rank     = room_raider::mixed_fft_rank(lengths[i][0], &radix);
+            UTEST_ASSERT_MSG((radix == lengths[i][1]) && (rank == lengths[i][2]),
+                "length=%d: radix=%d rank=%d", int(lengths[i][0]), int(radix), int(rank));
+        }
+    }
+
+    void fill_signal(float *re, float *im, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            re[i]       = sinf(i * 0.37f) + 0.5f * cosf(i * i * 0.011f);
+            im[i]       = cosf(i * 0.13f) - 0.25f * sinf(i * 1.7f);
+        }
+    }
+
+    void test_transform(size_t radix, size_t rank, size_t bins)
+    {
+        printf("Testing mixed-radix transform radix=%d rank=%d...\n", int(radix), int(rank));
+
+        size_t count    = radix << rank;
+        uint8_t *data   = NULL;
+        float *re       = alloc_aligned<float>(data, count * 4);
+        UTEST_ASSERT(re != NULL);
+        float *im       = &re[count];
+        float *src_re   = &im[count];
+        float *src_im   = &src_re[count];
+
+        fill_signal(src_re, src_im, count);
+        for (size_t i=0; i<count; ++i)
+        {
+            re[i]           = src_re[i];
+            im[i]           = src_im[i];
+        }
+
+        // Compare the bins with the DFT computed in double precision
+        room_raider::mixed_direct_fft(re, im, radix, rank);
+        double norm     = sqrt(double(count));
+        for (size_t b=0; b<bins; ++b)
+        {
+            size_t k        = (b * 7919) % count;
+            double xr       = 0.0, xi = 0.0;
+            for (size_t n=0; n<count; ++n)
+            {
+                double a        = -2.0 * M_PI * double((n * k) % count) / count;
+                xr             += src_re[n] * cos(a) - src_im[n] * sin(a);
+                xi             += src_re[n] * sin(a) + src_im[n] * cos(a);
+            }
+
+            size_t p        = room_raider::mixed_fft_bin(k, radix, rank);
+            UTEST_ASSERT(p < count);
+            double err      = sqrt((xr - re[p]) * (xr - re[p]) + (xi - im[p]) * (xi - im[p])) / norm;
+            UTEST_ASSERT_MSG(err < TOLERANCE, "bin %d: (%f, %f) != (%f, %f)", int(k), re[p], im[p], xr, xi);
+        }
+
+        // The reverse transform restores the signal
+        room_raider::mixed_reverse_fft(re, im, radix, rank);
+        for (size_t i=0; i<count; ++i)
+        {
+            UTEST_ASSERT_MSG((fabsf(re[i] - src_re[i]) < TOLERANCE * 10) && (fabsf(im[i] - src_im[i]) < TOLERANCE * 10),
+                "sample %d: (%f, %f) != (%f, %f)", int(i), re[i], im[i], src_re[i], src_im[i]);
+        }
+
+        free_aligned(data);
+    }
+
+    UTEST_MAIN
+    {
+        test_rank();
+
+        for (size_t radix=1; radix <= 5; radix += 2)
+        {
+            test_transform(radix, SMALL_RANK, radix << SMALL_RANK);
+            test_transform(radix, LARGE_RANK, LARGE_BINS);
+        }
+    }
+
+UTEST_END
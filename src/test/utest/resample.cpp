@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of room-raider
+ * Created on: 17 окт. 2026 г.
+ *
+ * room-raider is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * room-raider is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with room-raider. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/resample.h>
+
+#define LENGTH              5000        // Length of the source, samples
+#define CHANNELS            3           // Number of channels
+#define THREADS             2           // Number of threads, less than channels
+#define TOLERANCE           1e-4        // Maximum difference from the direct computation
+
+UTEST_BEGIN("room_raider", resample)
+
+    void make_source(dspu::Sample &s, size_t srate)
+    {
+        UTEST_ASSERT(s.init(CHANNELS, LENGTH, LENGTH));
+        s.set_sample_rate(srate);
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            float *buf          = s.getBuffer(i);
+            for (size_t n=0; n<LENGTH; ++n)
+                buf[n]              = sinf(n * (0.01f + i * 0.02f)) + 0.1f * cosf(n * 1.3f);
+        }
+    }
+
+    // Output sample computed directly from the polyphase table of the resampler
+    double direct_sample(const room_raider::resampler_t *r, size_t k, const float *src, size_t length)
+    {
+        ssize_t half    = r->nTaps >> 1;
+        wsize_t pos     = wsize_t(k) * r->nDown;
+        ssize_t start   = ssize_t(pos / r->nUp) - half + 1;
+        const float *h  = &r->vKernel[(pos % r->nUp) * r->nTaps];
+        double v        = 0.0;
+        for (size_t j=0; j<r->nTaps; ++j)
+        {
+            ssize_t idx     = start + j;
+            if ((idx >= 0) && (idx < ssize_t(length)))
+                v              += double(h[j]) * src[idx];
+        }
+        return v;
+    }
+
+    void test_rates(size_t src_rate, size_t dst_rate)
+    {
+        printf("Testing resampling %d -> %d...\n", int(src_rate), int(dst_rate));
+
+        dspu::Sample src, dst;
+        make_source(src, src_rate);
+        make_source(dst, src_rate);
+
+        room_raider::resampler_t r;
+        UTEST_ASSERT(room_raider::init_resampler(&r, src_rate, dst_rate) == STATUS_OK);
+        size_t length   = room_raider::resampled_length(&r, LENGTH);
+
+        // The decimated signal is computed in place, the interpolated one in the new buffers
+        UTEST_ASSERT(room_raider::resample(&dst, dst_rate, THREADS) == STATUS_OK);
+        UTEST_ASSERT(dst.sample_rate() == dst_rate);
+        UTEST_ASSERT(dst.channels() == CHANNELS);
+        UTEST_ASSERT(dst.length() == length);
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            const float *a  = src.getBuffer(i);
+            const float *b  = dst.getBuffer(i);
+            for (size_t k=0; k<length; ++k)
+            {
+                double v        = direct_sample(&r, k, a, LENGTH);
+                UTEST_ASSERT_MSG(fabs(v - b[k]) < TOLERANCE,
+                    "Channel %d sample %d: %f != %f", int(i), int(k), b[k], v);
+            }
+        }
+
+        room_raider::destroy_resampler(&r);
+    }
+
+    UTEST_MAIN
+    {
+        test_rates(48000, 44100);
+        test_rates(96000, 48000);
+        test_rates(48000, 8000);
+        test_rates(44100, 48000);
+        test_rates(48000, 96000);
+    }
+
+UTEST_END